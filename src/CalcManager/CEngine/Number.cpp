@@ -7,24 +7,138 @@ using namespace std;
 
 namespace CalcEngine
 {
+    DigitBuffer::DigitBuffer() noexcept
+        : m_heapCapacity{ 0 }
+        , m_size{ 0 }
+    {
+    }
+
+    DigitBuffer::DigitBuffer(uint32_t const* digits, size_t count)
+        : DigitBuffer()
+    {
+        Assign(digits, count);
+    }
+
+    DigitBuffer::DigitBuffer(initializer_list<uint32_t> digits)
+        : DigitBuffer(digits.begin(), digits.size())
+    {
+    }
+
+    DigitBuffer::DigitBuffer(DigitBuffer const& other)
+        : DigitBuffer(other.data(), other.size())
+    {
+    }
+
+    DigitBuffer::DigitBuffer(DigitBuffer&& other) noexcept
+        : DigitBuffer()
+    {
+        *this = move(other);
+    }
+
+    DigitBuffer& DigitBuffer::operator=(DigitBuffer const& other)
+    {
+        if (this != &other)
+        {
+            Assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    DigitBuffer& DigitBuffer::operator=(DigitBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (other.m_size > INLINE_DIGITS)
+            {
+                m_heap = move(other.m_heap);
+                m_heapCapacity = other.m_heapCapacity;
+                other.m_heapCapacity = 0;
+            }
+            else
+            {
+                copy_n(other.m_inline, other.m_size, m_inline);
+            }
+            m_size = other.m_size;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    void DigitBuffer::Assign(uint32_t const* digits, size_t count)
+    {
+        if (count > INLINE_DIGITS && count > m_heapCapacity)
+        {
+            m_heap = make_unique<uint32_t[]>(count);
+            m_heapCapacity = count;
+        }
+        m_size = count;
+        copy_n(digits, count, count > INLINE_DIGITS ? m_heap.get() : m_inline);
+    }
+
+    size_t DigitBuffer::size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool DigitBuffer::empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    uint32_t const* DigitBuffer::data() const noexcept
+    {
+        return m_size > INLINE_DIGITS ? m_heap.get() : m_inline;
+    }
+
+    uint32_t const* DigitBuffer::begin() const noexcept
+    {
+        return data();
+    }
+
+    uint32_t const* DigitBuffer::end() const noexcept
+    {
+        return data() + m_size;
+    }
+
+    uint32_t const& DigitBuffer::front() const
+    {
+        return data()[0];
+    }
+
+    uint32_t const& DigitBuffer::back() const
+    {
+        return data()[m_size - 1];
+    }
+
+    uint32_t const& DigitBuffer::operator[](size_t index) const
+    {
+        return data()[index];
+    }
+
     Number::Number() noexcept
         : Number(1, 0, { 0 })
     {
     }
 
-    Number::Number(int32_t sign, int32_t exp, vector<uint32_t> const& mantissa) noexcept
+    Number::Number(int32_t sign, int32_t exp, initializer_list<uint32_t> mantissa)
         : m_sign{ sign }
         , m_exp{ exp }
         , m_mantissa{ mantissa }
     {
     }
 
-    Number::Number(PNUMBER p) noexcept
+    Number::Number(int32_t sign, int32_t exp, DigitBuffer const& mantissa)
+        : m_sign{ sign }
+        , m_exp{ exp }
+        , m_mantissa{ mantissa }
+    {
+    }
+
+    Number::Number(PNUMBER p)
         : m_sign{ p->sign }
         , m_exp{ p->exp }
+        , m_mantissa{ p->mant, static_cast<size_t>(p->cdigit) }
     {
-        m_mantissa.reserve(p->cdigit);
-        copy_n(p->mant, p->cdigit, back_inserter(m_mantissa));
     }
 
     PNUMBER Number::ToPNUMBER() const
@@ -34,11 +148,7 @@ namespace CalcEngine
         ret->exp = this->Exp();
         ret->cdigit = static_cast<int32_t>(this->Mantissa().size());
 
-        MANTTYPE* ptrRet = ret->mant;
-        for (auto const& digit : this->Mantissa())
-        {
-            *ptrRet++ = digit;
-        }
+        copy(this->Mantissa().begin(), this->Mantissa().end(), ret->mant);
 
         return ret;
     }
@@ -53,7 +163,7 @@ namespace CalcEngine
         return m_exp;
     }
 
-    vector<uint32_t> const& Number::Mantissa() const
+    DigitBuffer const& Number::Mantissa() const
     {
         return m_mantissa;
     }
@@ -4,15 +4,164 @@
 
 using namespace std;
 
+namespace
+{
+    // A rational p/q made from the two numbers.
+    PRAT NumbersToRat(CalcEngine::Number const& p, CalcEngine::Number const& q)
+    {
+        PRAT prat = _createrat();
+        try
+        {
+            prat->pp = p.ToPNUMBER();
+            prat->pq = q.ToPNUMBER();
+        }
+        catch (uint32_t error)
+        {
+            destroyrat(prat);
+            throw(error);
+        }
+        return prat;
+    }
+
+    uint64_t Magnitude(int64_t i)
+    {
+        return i < 0 ? 0 - static_cast<uint64_t>(i) : static_cast<uint64_t>(i);
+    }
+
+    // The Ratpack number with the value of i.
+    PNUMBER Int64ToNum(int64_t i)
+    {
+        uint64_t mag = Magnitude(i);
+        PNUMBER pnum = _createnum(2);
+        pnum->sign = i < 0 ? -1 : 1;
+        pnum->exp = 0;
+        pnum->mant[0] = static_cast<MANTTYPE>(mag);
+        pnum->mant[1] = static_cast<MANTTYPE>(mag >> 32);
+        pnum->cdigit = pnum->mant[1] != 0 ? 2 : 1;
+        return pnum;
+    }
+
+    // A rational p/q made from the two integers.
+    PRAT Int64sToRat(int64_t p, int64_t q)
+    {
+        PRAT prat = _createrat();
+        try
+        {
+            prat->pp = Int64ToNum(p);
+            prat->pq = Int64ToNum(q);
+        }
+        catch (uint32_t error)
+        {
+            destroyrat(prat);
+            throw(error);
+        }
+        return prat;
+    }
+
+    // Whether the number with these digits fits in an int64_t, which takes
+    // its value if so.  Negative zero has no int64_t and doesn't fit.
+    bool DigitsToInt64(int32_t sign, int32_t exp, MANTTYPE const* mant, int32_t cdigit, int64_t& i)
+    {
+        if (exp < 0 || cdigit + exp > 2)
+        {
+            return false;
+        }
+
+        uint64_t mag = 0;
+        for (int32_t digit = cdigit - 1; digit >= 0; digit--)
+        {
+            mag = (mag << 32) | mant[digit];
+        }
+        mag <<= 32 * exp;
+        if (mag > INT64_MAX || (mag == 0 && sign != 1))
+        {
+            return false;
+        }
+
+        i = sign < 0 ? -static_cast<int64_t>(mag) : static_cast<int64_t>(mag);
+        return true;
+    }
+
+    bool NumToInt64(PNUMBER pnum, int64_t& i)
+    {
+        return DigitsToInt64(pnum->sign, pnum->exp, pnum->mant, pnum->cdigit, i);
+    }
+
+    bool NumberToInt64(CalcEngine::Number const& n, int64_t& i)
+    {
+        auto const& mantissa = n.Mantissa();
+        return DigitsToInt64(n.Sign(), n.Exp(), mantissa.data(), static_cast<int32_t>(mantissa.size()), i);
+    }
+
+    // The Number with the value of i, laid out like Int64ToNum.
+    CalcEngine::Number Int64ToNumber(int64_t i)
+    {
+        uint64_t mag = Magnitude(i);
+        int32_t sign = i < 0 ? -1 : 1;
+        uint32_t lo = static_cast<uint32_t>(mag);
+        uint32_t hi = static_cast<uint32_t>(mag >> 32);
+        return hi != 0 ? CalcEngine::Number{ sign, 0, { lo, hi } } : CalcEngine::Number{ sign, 0, { lo } };
+    }
+
+    // Sum and product of values no bigger than INT64_MAX, false when the
+    // result isn't.  INT64_MIN is left out so that every value can be negated.
+    bool CheckedAdd(int64_t a, int64_t b, int64_t& sum)
+    {
+        if (a > 0 ? b > INT64_MAX - a : b < -INT64_MAX - a)
+        {
+            return false;
+        }
+        sum = a + b;
+        return true;
+    }
+
+    bool CheckedMul(int64_t a, int64_t b, int64_t& product)
+    {
+        uint64_t ma = Magnitude(a);
+        uint64_t mb = Magnitude(b);
+        if (ma != 0 && mb > INT64_MAX / ma)
+        {
+            return false;
+        }
+        int64_t mag = static_cast<int64_t>(ma * mb);
+        product = (a < 0) != (b < 0) ? -mag : mag;
+        return true;
+    }
+
+    // Divides p and q by their G.C.D., keeping their signs.  reducerat leaves
+    // values this short alone, on native integers the G.C.D. costs next to
+    // nothing and keeps exponents such as 2/6 in lowest terms for powrat.
+    void ReduceInt64s(int64_t& p, int64_t& q)
+    {
+        uint64_t u = Magnitude(p);
+        uint64_t v = Magnitude(q);
+        while (v != 0)
+        {
+            uint64_t r = u % v;
+            u = v;
+            v = r;
+        }
+        if (u > 1)
+        {
+            p /= static_cast<int64_t>(u);
+            q /= static_cast<int64_t>(u);
+        }
+    }
+}
+
 namespace CalcEngine
 {
-    Rational::Rational() noexcept
-        : m_p{}
-        , m_q{ 1, 0, { 1 } }
+    Rational::Rational()
+        : m_rat{ nullptr }
+        , m_p{ 0 }
+        , m_q{ 1 }
     {
     }
 
-    Rational::Rational(Number const& n) noexcept
+    Rational::Rational(Number const& n)
+        : m_rat{ nullptr }
+        , m_p{ 0 }
+        , m_q{ 1 }
     {
         int32_t qExp = 0;
         if (n.Exp() < 0)
@@ -20,166 +169,346 @@ namespace CalcEngine
             qExp -= n.Exp();
         }
 
-        m_p = Number(n.Sign(), 0, n.Mantissa());
-        m_q = Number(1, qExp, { 1 });
+        Number p(n.Sign(), 0, n.Mantissa());
+        Number q(1, qExp, { 1 });
+        if (!NumberToInt64(p, m_p) || !NumberToInt64(q, m_q))
+        {
+            m_rat = NumbersToRat(p, q);
+        }
     }
 
-    Rational::Rational(Number const& p, Number const& q) noexcept
-        : m_p{ p }
-        , m_q{ q }
+    Rational::Rational(Number const& p, Number const& q)
+        : m_rat{ nullptr }
+        , m_p{ 0 }
+        , m_q{ 1 }
     {
+        if (!NumberToInt64(p, m_p) || !NumberToInt64(q, m_q))
+        {
+            m_rat = NumbersToRat(p, q);
+        }
     }
 
     Rational::Rational(int32_t i)
+        : m_rat{ nullptr }
+        , m_p{ i }
+        , m_q{ 1 }
     {
-        PRAT pr = i32torat(static_cast<int32_t>(i));
-
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
-
-        destroyrat(pr);
     }
 
     Rational::Rational(uint32_t ui)
+        : m_rat{ nullptr }
+        , m_p{ ui }
+        , m_q{ 1 }
     {
-        PRAT pr = Ui32torat(static_cast<uint32_t>(ui));
-
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
-
-        destroyrat(pr);
     }
 
     Rational::Rational(uint64_t ui)
+        : m_rat{ nullptr }
+        , m_p{ 0 }
+        , m_q{ 1 }
     {
+        if (ui <= INT64_MAX)
+        {
+            m_p = static_cast<int64_t>(ui);
+            return;
+        }
+
         uint32_t hi = (uint32_t)(((ui) >> 32) & 0xffffffff);
         uint32_t lo = (uint32_t)ui;
 
         Rational temp = (Rational{ hi } << 32) | lo;
 
-        m_p = Number{ temp.P() };
-        m_q = Number{ temp.Q() };
+        m_rat = temp.m_rat;
+        temp.m_rat = nullptr;
+    }
+
+    Rational::Rational(PRAT prat)
+        : m_rat{ nullptr }
+        , m_p{ 0 }
+        , m_q{ 1 }
+    {
+        if (!NumToInt64(prat->pp, m_p) || !NumToInt64(prat->pq, m_q))
+        {
+            DUPRAT(m_rat, prat);
+        }
+    }
+
+    Rational::Rational(Rational const& other)
+        : m_rat{ nullptr }
+        , m_p{ other.m_p }
+        , m_q{ other.m_q }
+    {
+        if (!other.IsSmall())
+        {
+            DUPRAT(m_rat, other.m_rat);
+        }
+    }
+
+    Rational::Rational(Rational&& other) noexcept
+        : m_rat{ other.m_rat }
+        , m_p{ other.m_p }
+        , m_q{ other.m_q }
+    {
+        // Left as zero.
+        other.m_rat = nullptr;
+        other.m_p = 0;
+        other.m_q = 1;
+    }
+
+    Rational& Rational::operator=(Rational const& other)
+    {
+        if (this != &other)
+        {
+            if (other.IsSmall())
+            {
+                destroyrat(m_rat);
+                m_p = other.m_p;
+                m_q = other.m_q;
+            }
+            else
+            {
+                // Reuses the numbers of this one when they have room.
+                DUPRAT(m_rat, other.m_rat);
+            }
+        }
+
+        return *this;
+    }
+
+    Rational& Rational::operator=(Rational&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroyrat(m_rat);
+            m_rat = other.m_rat;
+            m_p = other.m_p;
+            m_q = other.m_q;
+            other.m_rat = nullptr;
+            other.m_p = 0;
+            other.m_q = 1;
+        }
+
+        return *this;
+    }
+
+    Rational::~Rational()
+    {
+        destroyrat(m_rat);
+    }
+
+    bool Rational::IsSmall() const
+    {
+        return m_rat == nullptr;
+    }
+
+    PRAT& Rational::Promote() const
+    {
+        if (m_rat == nullptr)
+        {
+            m_rat = Int64sToRat(m_p, m_q);
+        }
+
+        return m_rat;
+    }
+
+    void Rational::Demote()
+    {
+        int64_t p;
+        int64_t q;
+        if (m_rat != nullptr && NumToInt64(m_rat->pp, p) && NumToInt64(m_rat->pq, q))
+        {
+            destroyrat(m_rat);
+            m_p = p;
+            m_q = q;
+        }
     }
 
-    Rational::Rational(PRAT prat) noexcept
-        : m_p{ Number{ prat->pp } }
-        , m_q{ Number{ prat->pq } }
+    // Adds p/q the way addrat does, false when the result doesn't fit or is
+    // zero, whose sign is left to addrat.
+    bool Rational::AddSmall(int64_t p, int64_t q)
     {
+        int64_t resultP;
+        int64_t resultQ;
+        if (Magnitude(m_q) == Magnitude(q))
+        {
+            // addrat adds the tops when the bottoms match, signs moved up.
+            if (!CheckedAdd(m_q < 0 ? -m_p : m_p, q < 0 ? -p : p, resultP))
+            {
+                return false;
+            }
+            resultQ = m_q < 0 ? -m_q : m_q;
+        }
+        else
+        {
+            int64_t left;
+            int64_t right;
+            if (!CheckedMul(m_p, q, left) || !CheckedMul(m_q, p, right) || !CheckedAdd(left, right, resultP) || !CheckedMul(m_q, q, resultQ))
+            {
+                return false;
+            }
+            if (resultQ < 0)
+            {
+                resultP = -resultP;
+                resultQ = -resultQ;
+            }
+        }
+
+        if (resultP == 0)
+        {
+            return false;
+        }
+
+        ReduceInt64s(resultP, resultQ);
+        m_p = resultP;
+        m_q = resultQ;
+        return true;
+    }
+
+    // Multiplies by p/q the way mulrat does, false when the result doesn't
+    // fit or is zero.
+    bool Rational::MulSmall(int64_t p, int64_t q)
+    {
+        if (m_p == 0)
+        {
+            m_q = 1;
+            return true;
+        }
+
+        int64_t resultP;
+        int64_t resultQ;
+        if (!CheckedMul(m_p, p, resultP) || !CheckedMul(m_q, q, resultQ) || resultP == 0)
+        {
+            return false;
+        }
+
+        ReduceInt64s(resultP, resultQ);
+        m_p = resultP;
+        m_q = resultQ;
+        return true;
     }
 
     PRAT Rational::ToPRAT() const
     {
-        PRAT ret = _createrat();
+        if (IsSmall())
+        {
+            return Int64sToRat(m_p, m_q);
+        }
 
-        ret->pp = this->P().ToPNUMBER();
-        ret->pq = this->Q().ToPNUMBER();
+        PRAT ret = nullptr;
+        DUPRAT(ret, m_rat);
 
         return ret;
     }
 
-    Number const& Rational::P() const
+    Number Rational::P() const
     {
-        return m_p;
+        return IsSmall() ? Int64ToNumber(m_p) : Number{ m_rat->pp };
     }
 
-    Number const& Rational::Q() const
+    Number Rational::Q() const
     {
-        return m_q;
+        return IsSmall() ? Int64ToNumber(m_q) : Number{ m_rat->pq };
     }
 
-    Rational Rational::operator-() const
+    PRAT& Rational::Rat()
     {
-        return Rational{ Number{ -1 * m_p.Sign(), m_p.Exp(), m_p.Mantissa() }, m_q };
+        return Promote();
     }
 
-    Rational& Rational::operator+=(Rational const& rhs)
+    PRAT Rational::Rat() const
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        return Promote();
+    }
 
-        try
+    Rational Rational::operator-() const&
+    {
+        return -Rational{ *this };
+    }
+
+    Rational Rational::operator-() &&
+    {
+        if (IsSmall() && m_p != 0)
         {
-            addrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            m_p = -m_p;
         }
-        catch (uint32_t error)
+        else
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            // Negative zero only has the Ratpack form.
+            Promote()->pp->sign *= -1;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        return move(*this);
+    }
+
+    Rational& Rational::operator+=(Rational const& rhs)
+    {
+        if (IsSmall() && rhs.IsSmall() && AddSmall(rhs.m_p, rhs.m_q))
+        {
+            return *this;
+        }
+
+        if (this == &rhs)
+        {
+            return *this += Rational{ rhs };
+        }
+
+        addrat(&Promote(), rhs.Promote(), RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator-=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (IsSmall() && rhs.IsSmall() && AddSmall(-rhs.m_p, rhs.m_q))
         {
-            subrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            return *this;
         }
-        catch (uint32_t error)
+
+        if (this == &rhs)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this -= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        subrat(&Promote(), rhs.Promote(), RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator*=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (IsSmall() && rhs.IsSmall() && MulSmall(rhs.m_p, rhs.m_q))
         {
-            mulrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            return *this;
         }
-        catch (uint32_t error)
+
+        if (this == &rhs)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this *= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        mulrat(&Promote(), rhs.Promote(), RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator/=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        // divrat multiplies by q/p, dividing by zero is left to it.
+        if (IsSmall() && rhs.IsSmall() && rhs.m_p != 0 && MulSmall(rhs.m_q, rhs.m_p))
         {
-            divrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            return *this;
         }
-        catch (uint32_t error)
+
+        if (this == &rhs)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this /= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        divrat(&Promote(), rhs.Promote(), RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
@@ -193,136 +522,78 @@ namespace CalcEngine
     /// </remarks>
     Rational& Rational::operator%=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (this == &rhs)
         {
-            remrat(&lhsRat, rhsRat);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this %= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        remrat(&Promote(), rhs.Promote());
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator<<=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (this == &rhs)
         {
-            lshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this <<= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        lshrat(&Promote(), rhs.Promote(), RATIONAL_BASE, RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator>>=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (this == &rhs)
         {
-            rshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this >>= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        rshrat(&Promote(), rhs.Promote(), RATIONAL_BASE, RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator&=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (this == &rhs)
         {
-            andrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this &= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        andrat(&Promote(), rhs.Promote(), RATIONAL_BASE, RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator|=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
+        if (this == &rhs)
         {
-            orrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this |= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        orrat(&Promote(), rhs.Promote(), RATIONAL_BASE, RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
 
     Rational& Rational::operator^=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
-        {
-            xorrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
+        if (this == &rhs)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return *this ^= Rational{ rhs };
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        xorrat(&Promote(), rhs.Promote(), RATIONAL_BASE, RATIONAL_PRECISION);
+        Demote();
 
         return *this;
     }
@@ -396,25 +667,14 @@ namespace CalcEngine
 
     bool operator==(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        bool result = false;
-        try
+        int64_t left;
+        int64_t right;
+        if (lhs.IsSmall() && rhs.IsSmall() && CheckedMul(lhs.m_p, rhs.m_q, left) && CheckedMul(rhs.m_p, lhs.m_q, right))
         {
-            result = rat_equ(lhsRat, rhsRat, RATIONAL_PRECISION);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            return left == right;
         }
 
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
-
-        return result;
+        return rat_equ(lhs.Promote(), rhs.Promote(), RATIONAL_PRECISION);
     }
 
     bool operator!=(Rational const& lhs, Rational const& rhs)
@@ -424,25 +684,15 @@ namespace CalcEngine
 
     bool operator<(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        bool result = false;
-        try
+        int64_t left;
+        int64_t right;
+        if (lhs.IsSmall() && rhs.IsSmall() && CheckedMul(lhs.m_p, rhs.m_q, left) && CheckedMul(rhs.m_p, lhs.m_q, right))
         {
-            result = rat_lt(lhsRat, rhsRat, RATIONAL_PRECISION);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            // Both sides were multiplied by lhs.m_q * rhs.m_q.
+            return ((lhs.m_q < 0) == (rhs.m_q < 0)) ? left < right : right < left;
         }
 
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
-
-        return result;
+        return rat_lt(lhs.Promote(), rhs.Promote(), RATIONAL_PRECISION);
     }
 
     bool operator>(Rational const& lhs, Rational const& rhs)
@@ -462,40 +712,32 @@ namespace CalcEngine
 
     wstring Rational::ToString(uint32_t radix, NumberFormat fmt, int32_t precision) const
     {
-        PRAT rat = this->ToPRAT();
-        wstring result{};
-
-        try
+        if (IsSmall())
         {
-            result = RatToString(rat, fmt, radix, precision);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(rat);
-            throw(error);
+            // Converted on a copy, so that this one keeps the native form.
+            Rational promoted{ *this };
+            promoted.Promote();
+            return promoted.ToString(radix, fmt, precision);
         }
 
-        destroyrat(rat);
-
-        return result;
+        PRAT rat = m_rat;
+        return RatToString(rat, fmt, radix, precision);
     }
 
     uint64_t Rational::ToUInt64_t() const
     {
-        PRAT rat = this->ToPRAT();
-        uint64_t result;
-        try
+        if (IsSmall())
         {
-            result = rattoUi64(rat, RATIONAL_BASE, RATIONAL_PRECISION);
+            if (m_q == 1 && m_p >= 0)
+            {
+                return static_cast<uint64_t>(m_p);
+            }
+
+            Rational promoted{ *this };
+            promoted.Promote();
+            return promoted.ToUInt64_t();
         }
-        catch (uint32_t error)
-        {
-            destroyrat(rat);
-            throw(error);
-        }
-
-        destroyrat(rat);
 
-        return result;
+        return rattoUi64(m_rat, RATIONAL_BASE, RATIONAL_PRECISION);
     }
 }
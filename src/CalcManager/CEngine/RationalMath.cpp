@@ -6,135 +6,101 @@
 using namespace std;
 using namespace CalcEngine;
 
-Rational RationalMath::Frac(Rational const& rat)
+void RationalMath::FracInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-    try
-    {
-        fracrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    fracrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Frac(Rational const& rat)
+{
+    Rational result{ rat };
+    FracInPlace(result);
     return result;
 }
 
-Rational RationalMath::Integer(Rational const& rat)
+void RationalMath::IntegerInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-    try
-    {
-        intrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    intrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Integer(Rational const& rat)
+{
+    Rational result{ rat };
+    IntegerInPlace(result);
     return result;
 }
 
-Rational RationalMath::Pow(Rational const& base, Rational const& pow)
+void RationalMath::PowInPlace(Rational& base, Rational const& pow)
 {
-    PRAT baseRat = base.ToPRAT();
-    PRAT powRat = pow.ToPRAT();
+    powrat(&base.Rat(), pow.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
-    try
-    {
-        powrat(&baseRat, powRat, RATIONAL_BASE, RATIONAL_PRECISION);
-        destroyrat(powRat);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(baseRat);
-        destroyrat(powRat);
-        throw(error);
-    }
+Rational RationalMath::Pow(Rational const& base, Rational const& pow)
+{
+    Rational result{ base };
+    PowInPlace(result, pow);
+    return result;
+}
 
-    Rational result{ baseRat };
-    destroyrat(baseRat);
+void RationalMath::RootInPlace(Rational& base, Rational const& root)
+{
+    rootrat(&base.Rat(), root.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Root(Rational const& base, Rational const& root)
+{
+    Rational result{ base };
+    RootInPlace(result, root);
     return result;
 }
 
-Rational RationalMath::Root(Rational const& base, Rational const& root)
+void RationalMath::FactInPlace(Rational& rat)
 {
-    return Pow(base, Invert(root));
+    factrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
 }
 
 Rational RationalMath::Fact(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        factrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
+    Rational result{ rat };
+    FactInPlace(result);
     return result;
 }
 
-Rational RationalMath::Exp(Rational const& rat)
+void RationalMath::ExpInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        exprat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    exprat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Exp(Rational const& rat)
+{
+    Rational result{ rat };
+    ExpInPlace(result);
     return result;
 }
 
-Rational RationalMath::Log(Rational const& rat)
+void RationalMath::LogInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        lograt(&prat, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    lograt(&rat.Rat(), RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Log(Rational const& rat)
+{
+    Rational result{ rat };
+    LogInPlace(result);
     return result;
 }
 
+void RationalMath::Log10InPlace(Rational& rat)
+{
+    LogInPlace(rat);
+    divrat(&rat.Rat(), ln_ten, RATIONAL_PRECISION);
+}
+
 Rational RationalMath::Log10(Rational const& rat)
 {
-    return Log(rat) / Rational{ ln_ten };
+    Rational result{ rat };
+    Log10InPlace(result);
+    return result;
 }
 
 Rational RationalMath::Invert(Rational const& rat)
@@ -142,251 +108,168 @@ Rational RationalMath::Invert(Rational const& rat)
     return 1 / rat;
 }
 
-Rational RationalMath::Abs(Rational const& rat)
+void RationalMath::AbsInPlace(Rational& rat)
 {
-    return Rational{ Number{ 1, rat.P().Exp(), rat.P().Mantissa() }, Number{ 1, rat.Q().Exp(), rat.Q().Mantissa() } };
+    rat.Rat()->pp->sign = 1;
+    rat.Rat()->pq->sign = 1;
 }
 
-Rational RationalMath::Sin(Rational const& rat, AngleType angletype)
+Rational RationalMath::Abs(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        sinanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
+    Rational result{ rat };
+    AbsInPlace(result);
     return result;
 }
 
-Rational RationalMath::Cos(Rational const& rat, AngleType angletype)
+void RationalMath::SinInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        cosanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    sinanglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Sin(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    SinInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::Tan(Rational const& rat, AngleType angletype)
+void RationalMath::CosInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        tananglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    cosanglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Cos(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    CosInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::ASin(Rational const& rat, AngleType angletype)
+void RationalMath::TanInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        asinanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    tananglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Tan(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    TanInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::ACos(Rational const& rat, AngleType angletype)
+void RationalMath::ASinInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        acosanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    asinanglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::ASin(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    ASinInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::ATan(Rational const& rat, AngleType angletype)
+void RationalMath::ACosInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        atananglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    acosanglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::ACos(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    ACosInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::Sinh(Rational const& rat)
+void RationalMath::ATanInPlace(Rational& rat, AngleType angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        sinhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    atananglerat(&rat.Rat(), angletype, RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::ATan(Rational const& rat, AngleType angletype)
+{
+    Rational result{ rat };
+    ATanInPlace(result, angletype);
     return result;
 }
 
-Rational RationalMath::Cosh(Rational const& rat)
+void RationalMath::SinhInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        coshrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    sinhrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Sinh(Rational const& rat)
+{
+    Rational result{ rat };
+    SinhInPlace(result);
     return result;
 }
 
-Rational RationalMath::Tanh(Rational const& rat)
+void RationalMath::CoshInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        tanhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    coshrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Cosh(Rational const& rat)
+{
+    Rational result{ rat };
+    CoshInPlace(result);
     return result;
 }
 
-Rational RationalMath::ASinh(Rational const& rat)
+void RationalMath::TanhInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        asinhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    tanhrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::Tanh(Rational const& rat)
+{
+    Rational result{ rat };
+    TanhInPlace(result);
     return result;
 }
 
-Rational RationalMath::ACosh(Rational const& rat)
+void RationalMath::ASinhInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        acoshrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
+    asinhrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
+Rational RationalMath::ASinh(Rational const& rat)
+{
+    Rational result{ rat };
+    ASinhInPlace(result);
     return result;
 }
 
-Rational RationalMath::ATanh(Rational const& rat)
+void RationalMath::ACoshInPlace(Rational& rat)
 {
-    PRAT prat = rat.ToPRAT();
+    acoshrat(&rat.Rat(), RATIONAL_BASE, RATIONAL_PRECISION);
+}
 
-    try
-    {
-        atanhrat(&prat, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
+Rational RationalMath::ACosh(Rational const& rat)
+{
+    Rational result{ rat };
+    ACoshInPlace(result);
+    return result;
+}
 
-    Rational result{ prat };
-    destroyrat(prat);
+void RationalMath::ATanhInPlace(Rational& rat)
+{
+    atanhrat(&rat.Rat(), RATIONAL_PRECISION);
+}
 
+Rational RationalMath::ATanh(Rational const& rat)
+{
+    Rational result{ rat };
+    ATanhInPlace(result);
     return result;
 }
 
+void RationalMath::ModInPlace(Rational& a, Rational const& b)
+{
+    modrat(&a.Rat(), b.Rat());
+}
+
 /// <summary>
 /// Calculate the modulus after division, the sign of the result will match the sign of b.
 /// </summary>
@@ -397,22 +280,7 @@ Rational RationalMath::ATanh(Rational const& rat)
 /// </remarks>
 Rational RationalMath::Mod(Rational const& a, Rational const& b)
 {
-    PRAT prat = a.ToPRAT();
-    PRAT pn = b.ToPRAT();
-
-    try
-    {
-        modrat(&prat, pn);
-        destroyrat(pn);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        destroyrat(pn);
-        throw(error);
-    }
-
-    auto res = Rational{ prat };
-    destroyrat(prat);
-    return res;
+    Rational result{ a };
+    ModInPlace(result, b);
+    return result;
 }
@@ -26,13 +26,23 @@ using namespace CalcEngine::RationalMath;
 /* Routines for more complex mathematical functions/error checking. */
 CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& rat, uint32_t op)
 {
+    // The numbers freed while working out the function are reused within it, and released together at the end.
+    RatpakPoolScope poolScope;
     Rational result{};
     try
     {
         switch (op)
         {
         case IDC_CHOP:
-            result = m_bInv ? Frac(rat) : Integer(rat);
+            result = rat;
+            if (m_bInv)
+            {
+                FracInPlace(result);
+            }
+            else
+            {
+                IntegerInPlace(result);
+            }
             break;
 
             /* Return complement. */
@@ -51,7 +61,8 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
         case IDC_ROLC:
             if (m_fIntegerMode)
             {
-                result = Integer(rat);
+                result = rat;
+                IntegerInPlace(result);
 
                 uint64_t w64Bits = result.ToUInt64_t();
                 uint64_t msb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1;
@@ -75,7 +86,8 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
         case IDC_RORC:
             if (m_fIntegerMode)
             {
-                result = Integer(rat);
+                result = rat;
+                IntegerInPlace(result);
 
                 uint64_t w64Bits = result.ToUInt64_t();
                 uint64_t lsb = ((w64Bits & 0x01) == 1) ? 1 : 0;
@@ -113,84 +125,192 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
         case IDC_SIN: /* Sine; normal and arc */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ASin(rat, m_angletype) : Sin(rat, m_angletype);
+                result = rat;
+                if (m_bInv)
+                {
+                    ASinInPlace(result, m_angletype);
+                }
+                else
+                {
+                    SinInPlace(result, m_angletype);
+                }
             }
             break;
 
         case IDC_SINH: /* Sine- hyperbolic and archyperbolic */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ASinh(rat) : Sinh(rat);
+                result = rat;
+                if (m_bInv)
+                {
+                    ASinhInPlace(result);
+                }
+                else
+                {
+                    SinhInPlace(result);
+                }
             }
             break;
 
         case IDC_COS: /* Cosine, follows convention of sine function. */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ACos(rat, m_angletype) : Cos(rat, m_angletype);
+                result = rat;
+                if (m_bInv)
+                {
+                    ACosInPlace(result, m_angletype);
+                }
+                else
+                {
+                    CosInPlace(result, m_angletype);
+                }
             }
             break;
 
         case IDC_COSH: /* Cosine hyperbolic, follows convention of sine h function. */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ACosh(rat) : Cosh(rat);
+                result = rat;
+                if (m_bInv)
+                {
+                    ACoshInPlace(result);
+                }
+                else
+                {
+                    CoshInPlace(result);
+                }
             }
             break;
 
         case IDC_TAN: /* Same as sine and cosine. */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ATan(rat, m_angletype) : Tan(rat, m_angletype);
+                result = rat;
+                if (m_bInv)
+                {
+                    ATanInPlace(result, m_angletype);
+                }
+                else
+                {
+                    TanInPlace(result, m_angletype);
+                }
             }
             break;
 
         case IDC_TANH: /* Same as sine h and cosine h. */
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ATanh(rat) : Tanh(rat);
+                result = rat;
+                if (m_bInv)
+                {
+                    ATanhInPlace(result);
+                }
+                else
+                {
+                    TanhInPlace(result);
+                }
             }
             break;
 
         case IDC_SEC:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ACos(Invert(rat), m_angletype) : Invert(Cos(rat, m_angletype));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ACosInPlace(result, m_angletype);
+                }
+                else
+                {
+                    result = rat;
+                    CosInPlace(result, m_angletype);
+                    result = Invert(result);
+                }
             }
             break;
 
         case IDC_CSC:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ASin(Invert(rat), m_angletype) : Invert(Sin(rat, m_angletype));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ASinInPlace(result, m_angletype);
+                }
+                else
+                {
+                    result = rat;
+                    SinInPlace(result, m_angletype);
+                    result = Invert(result);
+                }
             }
             break;
 
         case IDC_COT:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ATan(Invert(rat), m_angletype) : Invert(Tan(rat, m_angletype));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ATanInPlace(result, m_angletype);
+                }
+                else
+                {
+                    result = rat;
+                    TanInPlace(result, m_angletype);
+                    result = Invert(result);
+                }
             }
             break;
 
         case IDC_SECH:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ACosh(Invert(rat)) : Invert(Cosh(rat));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ACoshInPlace(result);
+                }
+                else
+                {
+                    result = rat;
+                    CoshInPlace(result);
+                    result = Invert(result);
+                }
             }
             break;
 
         case IDC_CSCH:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ASinh(Invert(rat)) : Invert(Sinh(rat));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ASinhInPlace(result);
+                }
+                else
+                {
+                    result = rat;
+                    SinhInPlace(result);
+                    result = Invert(result);
+                }
             }
             break;
 
         case IDC_COTH:
             if (!m_fIntegerMode)
             {
-                result = m_bInv ? ATanh(Invert(rat)) : Invert(Tanh(rat));
+                if (m_bInv)
+                {
+                    result = Invert(rat);
+                    ATanhInPlace(result);
+                }
+                else
+                {
+                    result = rat;
+                    TanhInPlace(result);
+                    result = Invert(result);
+                }
             }
             break;
 
@@ -199,20 +319,31 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
             break;
 
         case IDC_SQR: /* Square */
-            result = Pow(rat, 2);
+            result = rat;
+            PowInPlace(result, 2);
             break;
 
         case IDC_SQRT: /* Square Root */
-            result = Root(rat, 2);
+            result = rat;
+            RootInPlace(result, 2);
             break;
 
         case IDC_CUBEROOT:
         case IDC_CUB: /* Cubing and cube root functions. */
-            result = IDC_CUBEROOT == op ? Root(rat, 3) : Pow(rat, 3);
+            result = rat;
+            if (IDC_CUBEROOT == op)
+            {
+                RootInPlace(result, 3);
+            }
+            else
+            {
+                PowInPlace(result, 3);
+            }
             break;
 
         case IDC_LOG: /* Functions for common log. */
-            result = Log10(rat);
+            result = rat;
+            Log10InPlace(result);
             break;
 
         case IDC_POW10:
@@ -224,11 +355,20 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
             break;
 
         case IDC_LN: /* Functions for natural log. */
-            result = m_bInv ? Exp(rat) : Log(rat);
+            result = rat;
+            if (m_bInv)
+            {
+                ExpInPlace(result);
+            }
+            else
+            {
+                LogInPlace(result);
+            }
             break;
 
         case IDC_FAC: /* Calculate factorial.  Inverse is ineffective. */
-            result = Fact(rat);
+            result = rat;
+            FactInPlace(result);
             break;
 
         case IDC_DEGREES:
@@ -250,7 +390,7 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
 
                 Rational secondRat = minuteRat;
 
-                minuteRat = Integer(minuteRat);
+                IntegerInPlace(minuteRat);
 
                 secondRat = (secondRat - minuteRat) * shftRat;
 
@@ -268,15 +408,18 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
             break;
         }
         case IDC_CEIL:
-            result = (Frac(rat) > 0) ? Integer(rat + 1) : Integer(rat);
+            result = (Frac(rat) > 0) ? rat + 1 : rat;
+            IntegerInPlace(result);
             break;
 
         case IDC_FLOOR:
-            result = (Frac(rat) < 0) ? Integer(rat - 1) : Integer(rat);
+            result = (Frac(rat) < 0) ? rat - 1 : rat;
+            IntegerInPlace(result);
             break;
 
         case IDC_ABS:
-            result = Abs(rat);
+            result = rat;
+            AbsInPlace(result);
             break;
 
         } // end switch( op )
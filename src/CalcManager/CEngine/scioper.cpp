@@ -29,11 +29,13 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
             break;
 
         case IDC_NAND:
-            result = (result & rhs) ^ GetChopNumber();
+            result &= rhs;
+            result ^= GetChopNumber();
             break;
 
         case IDC_NOR:
-            result = (result | rhs) ^ GetChopNumber();
+            result |= rhs;
+            result ^= GetChopNumber();
             break;
 
         case IDC_RSHF:
@@ -51,10 +53,10 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
             if (fMsb)
             {
-                result = Integer(result);
+                IntegerInPlace(result);
 
                 auto tempRat = GetChopNumber() >> holdVal;
-                tempRat = Integer(tempRat);
+                IntegerInPlace(tempRat);
 
                 result |= tempRat ^ GetChopNumber();
             }
@@ -95,7 +97,7 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
         case IDC_MOD:
         {
             int iNumeratorSign = 1, iDenominatorSign = 1;
-            auto temp = result;
+            auto temp = std::move(result);
             result = rhs;
 
             if (m_fIntegerMode)
@@ -126,7 +128,8 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
                 result /= temp;
                 if (m_fIntegerMode && (iNumeratorSign * iDenominatorSign) == -1)
                 {
-                    result = -(Integer(result));
+                    IntegerInPlace(result);
+                    result = -std::move(result);
                 }
             }
             else
@@ -138,13 +141,14 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
                     if (iNumeratorSign == -1)
                     {
-                        result = -(Integer(result));
+                        IntegerInPlace(result);
+                        result = -std::move(result);
                     }
                 }
                 else
                 {
                     // other modes, use modrat (modulus after division)
-                    result = Mod(result, temp);
+                    ModInPlace(result, temp);
                 }
             }
             break;
@@ -159,7 +163,8 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
             break;
 
         case IDC_LOGBASEY:
-            result = (Log(rhs) / Log(result));
+            LogInPlace(result);
+            result = Log(rhs) / result;
             break;
         }
     }
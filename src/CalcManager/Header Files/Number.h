@@ -3,29 +3,67 @@
 
 #pragma once
 
-#include <vector>
+#include <initializer_list>
+#include <memory>
 #include "Ratpack/ratpak.h"
 
 namespace CalcEngine
 {
+    // The digits of a Number's mantissa.  Short mantissas are kept in the
+    // object itself, only longer ones go to the heap.
+    class DigitBuffer
+    {
+    public:
+        // Measured over the results of the scientific functions at the
+        // default precision, about a third of the numbers have 1 to 4 digits
+        // and most of the rest 16 to 18, which is what fits inline.
+        static constexpr size_t INLINE_DIGITS = 18;
+
+        DigitBuffer() noexcept;
+        DigitBuffer(uint32_t const* digits, size_t count);
+        DigitBuffer(std::initializer_list<uint32_t> digits);
+        DigitBuffer(DigitBuffer const& other);
+        DigitBuffer(DigitBuffer&& other) noexcept;
+        DigitBuffer& operator=(DigitBuffer const& other);
+        DigitBuffer& operator=(DigitBuffer&& other) noexcept;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+        uint32_t const* data() const noexcept;
+        uint32_t const* begin() const noexcept;
+        uint32_t const* end() const noexcept;
+        uint32_t const& front() const;
+        uint32_t const& back() const;
+        uint32_t const& operator[](size_t index) const;
+
+    private:
+        void Assign(uint32_t const* digits, size_t count);
+
+        std::unique_ptr<uint32_t[]> m_heap; // the digits once there are more than INLINE_DIGITS
+        size_t m_heapCapacity;
+        size_t m_size;
+        uint32_t m_inline[INLINE_DIGITS];
+    };
+
     class Number
     {
     public:
         Number() noexcept;
-        Number(int32_t sign, int32_t exp, std::vector<uint32_t> const& mantissa) noexcept;
+        Number(int32_t sign, int32_t exp, std::initializer_list<uint32_t> mantissa);
+        Number(int32_t sign, int32_t exp, DigitBuffer const& mantissa);
 
-        explicit Number(PNUMBER p) noexcept;
+        explicit Number(PNUMBER p);
         PNUMBER ToPNUMBER() const;
 
         int32_t const& Sign() const;
         int32_t const& Exp() const;
-        std::vector<uint32_t> const& Mantissa() const;
+        DigitBuffer const& Mantissa() const;
 
         bool IsZero() const;
 
     private:
         int32_t m_sign;
         int32_t m_exp;
-        std::vector<uint32_t> m_mantissa;
+        DigitBuffer m_mantissa;
     };
 }
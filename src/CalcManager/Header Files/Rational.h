@@ -17,20 +17,33 @@ namespace CalcEngine
     class Rational
     {
     public:
-        Rational() noexcept;
-        Rational(Number const& n) noexcept;
-        Rational(Number const& p, Number const& q) noexcept;
+        Rational();
+        Rational(Number const& n);
+        Rational(Number const& p, Number const& q);
         Rational(int32_t i);
         Rational(uint32_t ui);
         Rational(uint64_t ui);
 
-        explicit Rational(PRAT prat) noexcept;
+        explicit Rational(PRAT prat);
         PRAT ToPRAT() const;
 
-        Number const& P() const;
-        Number const& Q() const;
+        Rational(Rational const& other);
+        Rational(Rational&& other) noexcept;
+        Rational& operator=(Rational const& other);
+        Rational& operator=(Rational&& other) noexcept;
+        ~Rational();
 
-        Rational operator-() const;
+        Number P() const;
+        Number Q() const;
+
+        // The Ratpack form owned by this Rational, for Ratpack routines to
+        // work on in place.  A value held as native integers is moved to the
+        // Ratpack form first.
+        PRAT& Rat();
+        PRAT Rat() const;
+
+        Rational operator-() const&;
+        Rational operator-() &&;
         Rational& operator+=(Rational const& rhs);
         Rational& operator-=(Rational const& rhs);
         Rational& operator*=(Rational const& rhs);
@@ -44,6 +57,7 @@ namespace CalcEngine
         Rational& operator|=(Rational const& rhs);
         Rational& operator^=(Rational const& rhs);
 
+        // lhs is taken by value, a temporary is moved in and worked on in place.
         friend Rational operator+(Rational lhs, Rational const& rhs);
         friend Rational operator-(Rational lhs, Rational const& rhs);
         friend Rational operator*(Rational lhs, Rational const& rhs);
@@ -68,7 +82,19 @@ namespace CalcEngine
         uint64_t ToUInt64_t() const;
 
     private:
-        Number m_p;
-        Number m_q;
+        bool IsSmall() const;
+        PRAT& Promote() const;
+        void Demote();
+        bool AddSmall(int64_t p, int64_t q);
+        bool MulSmall(int64_t p, int64_t q);
+
+        // While p and q fit in 64 bits the value is kept as the native
+        // integers m_p / m_q and m_rat is null.  It moves to the Ratpack form
+        // when a result overflows and whenever a Ratpack routine needs it.
+        // m_p and m_q are what the Ratpack form would hold, not reduced any
+        // further, so both forms give the same results.
+        mutable PRAT m_rat;
+        int64_t m_p;
+        int64_t m_q;
     };
 }
@@ -7,32 +7,56 @@
 
 namespace CalcEngine::RationalMath
 {
+    // The InPlace forms work on their first argument instead of making a
+    // new Rational for the result.
     Rational Frac(Rational const& rat);
+    void FracInPlace(Rational& rat);
     Rational Integer(Rational const& rat);
+    void IntegerInPlace(Rational& rat);
 
     Rational Pow(Rational const& base, Rational const& pow);
+    void PowInPlace(Rational& base, Rational const& pow);
     Rational Root(Rational const& base, Rational const& root);
+    void RootInPlace(Rational& base, Rational const& root);
     Rational Fact(Rational const& rat);
+    void FactInPlace(Rational& rat);
     Rational Mod(Rational const& a, Rational const& b);
+    void ModInPlace(Rational& a, Rational const& b);
 
     Rational Exp(Rational const& rat);
+    void ExpInPlace(Rational& rat);
     Rational Log(Rational const& rat);
+    void LogInPlace(Rational& rat);
     Rational Log10(Rational const& rat);
+    void Log10InPlace(Rational& rat);
 
     Rational Invert(Rational const& rat);
     Rational Abs(Rational const& rat);
+    void AbsInPlace(Rational& rat);
 
     Rational Sin(Rational const& rat, AngleType angletype);
+    void SinInPlace(Rational& rat, AngleType angletype);
     Rational Cos(Rational const& rat, AngleType angletype);
+    void CosInPlace(Rational& rat, AngleType angletype);
     Rational Tan(Rational const& rat, AngleType angletype);
+    void TanInPlace(Rational& rat, AngleType angletype);
     Rational ASin(Rational const& rat, AngleType angletype);
+    void ASinInPlace(Rational& rat, AngleType angletype);
     Rational ACos(Rational const& rat, AngleType angletype);
+    void ACosInPlace(Rational& rat, AngleType angletype);
     Rational ATan(Rational const& rat, AngleType angletype);
+    void ATanInPlace(Rational& rat, AngleType angletype);
 
     Rational Sinh(Rational const& rat);
+    void SinhInPlace(Rational& rat);
     Rational Cosh(Rational const& rat);
+    void CoshInPlace(Rational& rat);
     Rational Tanh(Rational const& rat);
+    void TanhInPlace(Rational& rat);
     Rational ASinh(Rational const& rat);
+    void ASinhInPlace(Rational& rat);
     Rational ACosh(Rational const& rat);
+    void ACoshInPlace(Rational& rat);
     Rational ATanh(Rational const& rat);
+    void ATanhInPlace(Rational& rat);
 }
@@ -15,7 +15,10 @@
 //
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring> // for memmove
+#include <vector>
 
 void _mulnumx(PNUMBER* pa, PNUMBER b);
 
@@ -43,6 +46,7 @@ void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b)
         if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 1 || (*pa)->exp != 0)
         {
             // pa and b are both non-one.
+            COUNTKERNEL(mulnumx, (*pa)->cdigit + b->cdigit);
             _mulnumx(pa, b);
         }
         else
@@ -62,87 +66,869 @@ void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b)
 
 //----------------------------------------------------------------------------
 //
-//    FUNCTION: _mulnumx
+//    FUNCTION: sqrnumx
 //
-//    ARGUMENTS: pointer to a number and a second number, the
-//               base is always BASEX.
+//    ARGUMENTS: pointer to a number, the base is always BASEX.
 //
-//    RETURN: None, changes first pointer.
+//    RETURN: None, changes the pointer.
 //
-//    DESCRIPTION: Does the number equivalent of *pa *= b.
-//    Assumes the base is BASEX of both numbers.  This algorithm is the
-//    same one you learned in grade school, except the base isn't 10 it's
-//    BASEX.
+//    DESCRIPTION: Does the number equivalent of *pa *= *pa.
+//    Cross products are only worked out once, and squares above
+//    g_mulNTTThreshold digits only transform the number once.
 //
 //----------------------------------------------------------------------------
 
-void _mulnumx(PNUMBER* pa, PNUMBER b)
+void sqrnumx(_Inout_ PNUMBER* pa)
 
 {
-    PNUMBER c = nullptr;  // c will contain the result.
-    PNUMBER a = nullptr;  // a is the dereferenced number pointer from *pa
-    MANTTYPE* ptra;       // ptra is a pointer to the mantissa of a.
-    MANTTYPE* ptrb;       // ptrb is a pointer to the mantissa of b.
-    MANTTYPE* ptrc;       // ptrc is a pointer to the mantissa of c.
-    MANTTYPE* ptrcoffset; // ptrcoffset, is the anchor location of the next
-                          // single digit multiply partial result.
-    int32_t iadigit = 0;  // Index of digit being used in the first number.
-    int32_t ibdigit = 0;  // Index of digit being used in the second number.
-    MANTTYPE da = 0;      // da is the digit from the fist number.
-    TWO_MANTTYPE cy = 0;  // cy is the carry resulting from the addition of
-                          // a multiplied row into the result.
-    TWO_MANTTYPE mcy = 0; // mcy is the resultant from a single
-                          // multiply, AND the carry of that multiply.
-    int32_t icdigit = 0;  // Index of digit being calculated in final result.
+    if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 1 || (*pa)->exp != 0)
+    {
+        _mulnumx(pa, *pa);
+    }
+    else
+    {
+        // pa is +/- 1, the square is one.
+        (*pa)->sign = 1;
+    }
+}
 
-    a = *pa;
+// Digit counts at which _mulnumx leaves the grade school algorithm for
+// Karatsuba, and Karatsuba for Toom-3.  Both compare against the length of the
+// shorter operand, setting one to INT32_MAX disables that tier.  Measured on
+// x64 the tiers break even at around 32 and 150 digits.
+int32_t g_mulKaratsubaThreshold = 32;
+int32_t g_mulToom3Threshold = 160;
+
+// Digit count of the shorter operand from which _mulnumx multiplies with a
+// number theoretic transform, it overtakes Toom-3 from around 4000 digits.
+int32_t g_mulNTTThreshold = 4096;
+
+namespace
+{
+    constexpr MANTTYPE MANTMASK = (MANTTYPE)(BASEX - 1); // bits of one BASEX digit
+
+    // Smallest operands the recursive tiers will split, whatever the thresholds say.
+    constexpr int32_t KARATSUBA_MIN = 4;
+    constexpr int32_t TOOM3_MIN = 9;
+
+    //----------------------------------------------------------------------------
+    //
+    //  The routines below work on raw little endian BASEX mantissas, they are
+    //  the kernels behind _mulnumx.  Results that do not fit in the space given
+    //  are reduced modulo BASEX**count, which is also how Toom-3 represents its
+    //  negative intermediates (two's complement in base BASEX).
+    //
+    //----------------------------------------------------------------------------
+
+    // pr[0..ca) = pa[0..ca) + pb[0..cb), ca >= cb, returns the carry out.
+    MANTTYPE addmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
+    {
+        TWO_MANTTYPE cy = 0;
+        int32_t i = 0;
+        for (; i < cb; i++)
+        {
+            cy += (TWO_MANTTYPE)pa[i] + pb[i];
+            pr[i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        for (; i < ca; i++)
+        {
+            cy += pa[i];
+            pr[i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        return (MANTTYPE)cy;
+    }
+
+    // pr[0..cr) += pa[0..ca), ca <= cr, modulo BASEX**cr, returns true if the
+    // sum wrapped around.
+    bool addmantto(MANTTYPE* pr, int32_t cr, const MANTTYPE* pa, int32_t ca)
+    {
+        TWO_MANTTYPE cy = 0;
+        int32_t i = 0;
+        for (; i < ca; i++)
+        {
+            cy += (TWO_MANTTYPE)pr[i] + pa[i];
+            pr[i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        for (; cy && i < cr; i++)
+        {
+            cy += pr[i];
+            pr[i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        return cy != 0;
+    }
 
-    ibdigit = a->cdigit + b->cdigit - 1;
-    createnum(c, ibdigit + 1);
-    c->cdigit = ibdigit;
-    c->sign = a->sign * b->sign;
+    // pr[0..cr) -= pa[0..ca), ca <= cr, modulo BASEX**cr, returns true if the
+    // difference wrapped around.
+    bool submantfrom(MANTTYPE* pr, int32_t cr, const MANTTYPE* pa, int32_t ca)
+    {
+        int64_t diff = 0;
+        bool borrow = false;
+        int32_t i = 0;
+        for (; i < ca; i++)
+        {
+            diff = (int64_t)pr[i] - pa[i] - (borrow ? 1 : 0);
+            borrow = diff < 0;
+            pr[i] = (MANTTYPE)(diff & MANTMASK);
+        }
+        for (; borrow && i < cr; i++)
+        {
+            borrow = pr[i] == 0;
+            pr[i] = (MANTTYPE)((pr[i] - 1) & MANTMASK);
+        }
+        return borrow;
+    }
 
-    c->exp = a->exp + b->exp;
-    ptra = a->mant;
-    ptrcoffset = c->mant;
+    // Two's complement helpers for Toom-3, all on cr digits.
+    bool isnegmant(const MANTTYPE* pr, int32_t cr)
+    {
+        return (pr[cr - 1] >> (BASEXPWR - 1)) != 0;
+    }
 
-    for (iadigit = a->cdigit; iadigit > 0; iadigit--)
+    void negmant(MANTTYPE* pr, int32_t cr)
     {
-        da = *ptra++;
-        ptrb = b->mant;
+        TWO_MANTTYPE cy = 1;
+        for (int32_t i = 0; i < cr; i++)
+        {
+            cy += (~pr[i]) & MANTMASK;
+            pr[i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+    }
 
-        // Shift ptrc, and ptrcoffset, one for each digit
-        ptrc = ptrcoffset++;
+    // Arithmetic shift right by one bit, exact when pr is even.
+    void halvemant(MANTTYPE* pr, int32_t cr)
+    {
+        MANTTYPE signbit = pr[cr - 1] & (MANTTYPE)(BASEX >> 1);
+        for (int32_t i = 0; i < cr - 1; i++)
+        {
+            pr[i] = (MANTTYPE)(((pr[i] >> 1) | (pr[i + 1] << (BASEXPWR - 1))) & MANTMASK);
+        }
+        pr[cr - 1] = (pr[cr - 1] >> 1) | signbit;
+    }
+
+    // Exact division by three, pr must be a multiple of three.  Multiplies by
+    // the inverse of three modulo BASEX one digit at a time, so it works for
+    // negative values too.
+    void div3mant(MANTTYPE* pr, int32_t cr)
+    {
+        constexpr TWO_MANTTYPE inv3 = 0xAAAAAAAAAAAAAAABULL & MANTMASK; // 3 * inv3 == 1 mod BASEX
+        MANTTYPE cy = 0;
+        for (int32_t i = 0; i < cr; i++)
+        {
+            MANTTYPE borrow = pr[i] < cy ? 1 : 0;
+            TWO_MANTTYPE t = (pr[i] - cy) & MANTMASK;
+            TWO_MANTTYPE q = (t * inv3) & MANTMASK;
+            pr[i] = (MANTTYPE)q;
+            cy = (MANTTYPE)((3 * q - t) >> BASEXPWR) + borrow;
+        }
+    }
 
-        for (ibdigit = b->cdigit; ibdigit > 0; ibdigit--)
+    // pr[0..ca+cb) = pa[0..ca) * pb[0..cb), grade school multiply.
+    void mulbasecase(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
+    {
+        memset(pr, 0, (ca + cb) * sizeof(MANTTYPE));
+        for (int32_t ia = 0; ia < ca; ia++)
         {
-            cy = 0;
-            mcy = (uint64_t)da * (*ptrb);
-            if (mcy)
+            TWO_MANTTYPE da = pa[ia];
+            if (da == 0)
             {
-                icdigit = 0;
-                if (ibdigit == 1 && iadigit == 1)
+                continue;
+            }
+
+            MANTTYPE* ptrc = pr + ia;
+            TWO_MANTTYPE cy = 0;
+            for (int32_t ib = 0; ib < cb; ib++)
+            {
+                cy += ptrc[ib] + da * pb[ib];
+                ptrc[ib] = (MANTTYPE)(cy & MANTMASK);
+                cy >>= BASEXPWR;
+            }
+            ptrc[cb] = (MANTTYPE)cy;
+        }
+    }
+
+    // pr[0..2*ca) = pa[0..ca)**2, grade school but each cross product is
+    // worked out once and doubled.
+    void sqrbasecase(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca)
+    {
+        memset(pr, 0, 2 * ca * sizeof(MANTTYPE));
+        for (int32_t ia = 0; ia < ca - 1; ia++)
+        {
+            TWO_MANTTYPE da = pa[ia];
+            if (da == 0)
+            {
+                continue;
+            }
+
+            MANTTYPE* ptrc = pr + ia;
+            TWO_MANTTYPE cy = 0;
+            for (int32_t ib = ia + 1; ib < ca; ib++)
+            {
+                cy += ptrc[ib] + da * pa[ib];
+                ptrc[ib] = (MANTTYPE)(cy & MANTMASK);
+                cy >>= BASEXPWR;
+            }
+            ptrc[ca] = (MANTTYPE)cy;
+        }
+
+        // Double the cross products and add in the squares of the digits.
+        TWO_MANTTYPE cy = 0;
+        for (int32_t i = 0; i < ca; i++)
+        {
+            TWO_MANTTYPE sq = (TWO_MANTTYPE)pa[i] * pa[i];
+            cy += ((TWO_MANTTYPE)pr[2 * i] << 1) + (sq & MANTMASK);
+            pr[2 * i] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+            cy += ((TWO_MANTTYPE)pr[2 * i + 1] << 1) + (sq >> BASEXPWR);
+            pr[2 * i + 1] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    //  Number theoretic transform multiply.  The digit convolution is done
+    //  modulo three primes of the form c*2**k+1 and put back together with the
+    //  chinese remainder theorem.  The product of the primes is just above
+    //  2**86, so it bounds any convolution term (cb * BASEX**2) while
+    //  cb <= 2**22, which ca + cb <= 2**23 guarantees, and 2**23 is also the
+    //  longest transform the first prime allows.  Everything is integer
+    //  arithmetic so results are exact.
+    //
+    //----------------------------------------------------------------------------
+
+    constexpr uint32_t NTT_P1 = 998244353; // 119 * 2**23 + 1
+    constexpr uint32_t NTT_P2 = 167772161; // 5 * 2**25 + 1
+    constexpr uint32_t NTT_P3 = 469762049; // 7 * 2**26 + 1
+    constexpr uint32_t NTT_ROOT = 3;       // primitive root of all three
+    constexpr int32_t NTT_MAXDIGITS = 1 << 23;
+
+    template <uint32_t P>
+    constexpr uint32_t mulmod(uint32_t a, uint32_t b)
+    {
+        return (uint32_t)((uint64_t)a * b % P);
+    }
+
+    template <uint32_t P>
+    constexpr uint32_t powmod(uint32_t a, uint32_t e)
+    {
+        uint32_t result = 1;
+        while (e > 0)
+        {
+            if (e & 1)
+            {
+                result = mulmod<P>(result, a);
+            }
+            a = mulmod<P>(a, a);
+            e >>= 1;
+        }
+        return result;
+    }
+
+    // In place transform of a power of two length, inverse includes the
+    // division by the length.  Each root w comes with floor(w * 2**32 / P) so
+    // the butterflies can reduce with a multiply instead of a divide.
+    template <uint32_t P>
+    void ntt(std::vector<uint32_t>& a, bool inverse, std::vector<uint32_t>& roots, std::vector<uint32_t>& rootquots)
+    {
+        size_t n = a.size();
+
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                std::swap(a[i], a[j]);
+            }
+        }
+
+        roots.resize(n / 2);
+        rootquots.resize(n / 2);
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            size_t half = len / 2;
+            uint32_t wlen = powmod<P>(NTT_ROOT, (uint32_t)((P - 1) / len));
+            if (inverse)
+            {
+                wlen = powmod<P>(wlen, P - 2);
+            }
+            roots[0] = 1;
+            for (size_t j = 1; j < half; j++)
+            {
+                roots[j] = mulmod<P>(roots[j - 1], wlen);
+            }
+            for (size_t j = 0; j < half; j++)
+            {
+                rootquots[j] = (uint32_t)(((uint64_t)roots[j] << 32) / P);
+            }
+
+            for (size_t i = 0; i < n; i += len)
+            {
+                uint32_t* plo = &a[i];
+                uint32_t* phi = &a[i + half];
+                for (size_t j = 0; j < half; j++)
                 {
-                    c->cdigit++;
+                    uint32_t u = plo[j];
+                    uint32_t q = (uint32_t)(((uint64_t)phi[j] * rootquots[j]) >> 32);
+                    uint32_t v = (uint32_t)((uint64_t)phi[j] * roots[j] - (uint64_t)q * P);
+                    if (v >= P)
+                    {
+                        v -= P;
+                    }
+                    plo[j] = (u + v >= P) ? u + v - P : u + v;
+                    phi[j] = (u >= v) ? u - v : u + P - v;
                 }
             }
+        }
 
-            // If result is nonzero, or while result of carry is nonzero...
-            while (mcy || cy)
+        if (inverse)
+        {
+            uint32_t ninv = powmod<P>((uint32_t)(n % P), P - 2);
+            for (auto& x : a)
             {
-                // update carry from addition(s) and multiply.
-                cy += (TWO_MANTTYPE)ptrc[icdigit] + ((uint32_t)mcy & ((uint32_t)~BASEX));
+                x = mulmod<P>(x, ninv);
+            }
+        }
+    }
 
-                // update result digit from
-                ptrc[icdigit++] = (MANTTYPE)((uint32_t)cy & ((uint32_t)~BASEX));
+    // pa * pb as a cyclic convolution of length n modulo P, left in conv.
+    template <uint32_t P>
+    void nttconvolve(std::vector<uint32_t>& conv, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, size_t n)
+    {
+        std::vector<uint32_t> roots;
+        std::vector<uint32_t> rootquots;
 
-                // update carries from
-                mcy >>= BASEXPWR;
-                cy >>= BASEXPWR;
+        conv.assign(n, 0);
+        for (int32_t i = 0; i < ca; i++)
+        {
+            conv[i] = pa[i] % P;
+        }
+        ntt<P>(conv, false, roots, rootquots);
+
+        if (pa == pb && ca == cb)
+        {
+            // Squaring, one forward transform is enough.
+            for (auto& x : conv)
+            {
+                x = mulmod<P>(x, x);
+            }
+        }
+        else
+        {
+            std::vector<uint32_t> convb(n, 0);
+            for (int32_t i = 0; i < cb; i++)
+            {
+                convb[i] = pb[i] % P;
             }
+            ntt<P>(convb, false, roots, rootquots);
+            for (size_t i = 0; i < n; i++)
+            {
+                conv[i] = mulmod<P>(conv[i], convb[i]);
+            }
+        }
 
-            ptrb++;
-            ptrc++;
+        ntt<P>(conv, true, roots, rootquots);
+    }
+
+    // pr[0..ca+cb) = pa[0..ca) * pb[0..cb), ca + cb <= NTT_MAXDIGITS.
+    void mulntt(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
+    {
+        int32_t cr = ca + cb;
+        size_t n = 1;
+        while (n < (size_t)cr - 1)
+        {
+            n <<= 1;
+        }
+
+        std::vector<uint32_t> r1, r2, r3;
+        nttconvolve<NTT_P1>(r1, pa, ca, pb, cb, n);
+        nttconvolve<NTT_P2>(r2, pa, ca, pb, cb, n);
+        nttconvolve<NTT_P3>(r3, pa, ca, pb, cb, n);
+
+        // Garner's form of the chinese remainder theorem, each term is
+        // x1 + P1 * (x2 + P2 * x3) with x1 < P1, x2 < P2, x3 < P3.
+        constexpr uint32_t inv_p1_p2 = powmod<NTT_P2>(NTT_P1 % NTT_P2, NTT_P2 - 2);
+        constexpr uint32_t inv_p1_p3 = powmod<NTT_P3>(NTT_P1 % NTT_P3, NTT_P3 - 2);
+        constexpr uint32_t inv_p2_p3 = powmod<NTT_P3>(NTT_P2 % NTT_P3, NTT_P3 - 2);
+
+        // The terms overlap three digits, w0..w2 hold the pending sums of
+        // the current digit and the next two.
+        TWO_MANTTYPE w0 = 0;
+        TWO_MANTTYPE w1 = 0;
+        TWO_MANTTYPE w2 = 0;
+        for (int32_t i = 0; i < cr; i++)
+        {
+            if (i < cr - 1)
+            {
+                uint32_t x1 = r1[i];
+                uint32_t x2 = mulmod<NTT_P2>((r2[i] + NTT_P2 - x1 % NTT_P2) % NTT_P2, inv_p1_p2);
+                uint32_t x3 = mulmod<NTT_P3>((r3[i] + NTT_P3 - x1 % NTT_P3) % NTT_P3, inv_p1_p3);
+                x3 = mulmod<NTT_P3>((x3 + NTT_P3 - x2 % NTT_P3) % NTT_P3, inv_p2_p3);
+
+                TWO_MANTTYPE t = x2 + (TWO_MANTTYPE)NTT_P2 * x3; // under 2**58
+                TWO_MANTTYPE lo = x1 + (TWO_MANTTYPE)NTT_P1 * (t & MANTMASK);
+                TWO_MANTTYPE hi = (lo >> BASEXPWR) + (TWO_MANTTYPE)NTT_P1 * (t >> BASEXPWR);
+                w0 += lo & MANTMASK;
+                w1 += hi & MANTMASK;
+                w2 += hi >> BASEXPWR;
+            }
+
+            pr[i] = (MANTTYPE)(w0 & MANTMASK);
+            w0 = w1 + (w0 >> BASEXPWR);
+            w1 = w2;
+            w2 = 0;
+        }
+    }
+
+    void mulmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, MANTTYPE* pws);
+    void sqrmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, MANTTYPE* pws);
+
+    // Which algorithm mulmant uses for a given pair of lengths.
+    enum class MulTier
+    {
+        Basecase,
+        Unbalanced,
+        Karatsuba,
+        Toom3,
+        NTT
+    };
+
+    MulTier multier(int32_t ca, int32_t cb)
+    {
+        // ca >= cb here.
+        if (cb < g_mulKaratsubaThreshold || cb < KARATSUBA_MIN)
+        {
+            return MulTier::Basecase;
+        }
+        if (cb >= g_mulNTTThreshold && ca <= NTT_MAXDIGITS - cb)
+        {
+            return MulTier::NTT;
+        }
+        if (ca >= 2 * cb)
+        {
+            return MulTier::Unbalanced;
+        }
+        // Toom-3 splits into thirds of the longer operand, the shorter one must
+        // still reach into the top third.
+        if (cb >= g_mulToom3Threshold && cb >= TOOM3_MIN && cb > 2 * ((ca + 2) / 3))
+        {
+            return MulTier::Toom3;
+        }
+        return MulTier::Karatsuba;
+    }
+
+    // Number of scratch digits mulmant needs for operands of these lengths.
+    size_t mulscratch(int32_t ca, int32_t cb)
+    {
+        if (ca < cb)
+        {
+            std::swap(ca, cb);
+        }
+
+        switch (multier(ca, cb))
+        {
+        case MulTier::Unbalanced:
+        {
+            int32_t clast = ca % cb;
+            size_t inner = mulscratch(cb, cb);
+            if (clast != 0)
+            {
+                inner = std::max(inner, mulscratch(clast, cb));
+            }
+            return 2 * cb + inner;
+        }
+        case MulTier::Karatsuba:
+        {
+            int32_t m = ca / 2;
+            int32_t ch = ca - m;
+            int32_t csb = std::max(m, cb - m) + 1;
+            size_t inner = std::max({ mulscratch(m, m), mulscratch(ch, cb - m), mulscratch(ch + 1, csb) });
+            return 4 * ((size_t)ch + 1) + inner;
+        }
+        case MulTier::Toom3:
+        {
+            int32_t k = (ca + 2) / 3;
+            size_t inner = std::max({ mulscratch(k, k), mulscratch(ca - 2 * k, cb - 2 * k), mulscratch(k + 1, k + 1) });
+            return 6 * ((size_t)k + 1) + 3 * (2 * (size_t)k + 2) + inner;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // ca >= 2 * cb: multiply pa by pb one cb sized slice of pa at a time.
+    void mulunbalanced(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, MANTTYPE* pws)
+    {
+        MANTTYPE* ptmp = pws;
+        MANTTYPE* pnext = pws + 2 * cb;
+
+        mulmant(pr, pa, cb, pb, cb, pnext);
+        memset(pr + 2 * cb, 0, (ca - cb) * sizeof(MANTTYPE));
+        for (int32_t offset = cb; offset < ca; offset += cb)
+        {
+            int32_t cslice = std::min(cb, ca - offset);
+            mulmant(ptmp, pa + offset, cslice, pb, cb, pnext);
+            addmantto(pr + offset, ca + cb - offset, ptmp, cslice + cb);
+        }
+    }
+
+    // cb <= ca < 2 * cb: with a = a1*B^m + a0 and b = b1*B^m + b0
+    // a*b = a1*b1*B^2m + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1)*B^m + a0*b0
+    void mulkaratsuba(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, MANTTYPE* pws)
+    {
+        int32_t m = ca / 2;   // digits in the low halves
+        int32_t ch = ca - m;  // digits in a1
+        int32_t cbh = cb - m; // digits in b1
+        int32_t cr = ca + cb;
+
+        MANTTYPE* psa = pws;
+        MANTTYPE* psb = psa + ch + 1;
+        MANTTYPE* pmid = psb + ch + 1;
+        MANTTYPE* pnext = pmid + 2 * (ch + 1);
+
+        // The low and high products land in place, side by side.
+        mulmant(pr, pa, m, pb, m, pnext);
+        mulmant(pr + 2 * m, pa + m, ch, pb + m, cbh, pnext);
+
+        psa[ch] = addmant(psa, pa + m, ch, pa, m);
+        int32_t csb;
+        if (cbh >= m)
+        {
+            psb[cbh] = addmant(psb, pb + m, cbh, pb, m);
+            csb = cbh + 1;
+        }
+        else
+        {
+            psb[m] = addmant(psb, pb, m, pb + m, cbh);
+            csb = m + 1;
+        }
+
+        int32_t cmid = ch + 1 + csb;
+        mulmant(pmid, psa, ch + 1, psb, csb, pnext);
+        submantfrom(pmid, cmid, pr, 2 * m);
+        submantfrom(pmid, cmid, pr + 2 * m, cr - 2 * m);
+        addmantto(pr + m, cr - m, pmid, std::min(cmid, cr - m));
+    }
+
+    // Evaluates x0 - x1 + x2 and x0 - 2*x1 + 4*x2 into ce digits each, returning
+    // the magnitudes and the signs separately.
+    void toom3evalneg(MANTTYPE* pm1, bool* pnegm1, MANTTYPE* pm2, bool* pnegm2, const MANTTYPE* px, int32_t k, int32_t cx2, int32_t ce)
+    {
+        const MANTTYPE* px1 = px + k;
+        const MANTTYPE* px2 = px + 2 * k;
+
+        memset(pm1, 0, ce * sizeof(MANTTYPE));
+        memcpy(pm1, px, k * sizeof(MANTTYPE));
+        addmantto(pm1, ce, px2, cx2);
+        submantfrom(pm1, ce, px1, k);
+
+        memset(pm2, 0, ce * sizeof(MANTTYPE));
+        memcpy(pm2, px2, cx2 * sizeof(MANTTYPE));
+        addmantto(pm2, ce, pm2, ce);
+        submantfrom(pm2, ce, px1, k);
+        addmantto(pm2, ce, pm2, ce);
+        addmantto(pm2, ce, px, k);
+
+        *pnegm1 = isnegmant(pm1, ce);
+        if (*pnegm1)
+        {
+            negmant(pm1, ce);
+        }
+        *pnegm2 = isnegmant(pm2, ce);
+        if (*pnegm2)
+        {
+            negmant(pm2, ce);
+        }
+    }
+
+    // Toom-3 with evaluation points 0, 1, -1, -2 and infinity, interpolated
+    // with Bodrato's sequence.  Requires cb <= ca and cb > 2*ceil(ca/3).
+    void multoom3(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, MANTTYPE* pws)
+    {
+        int32_t k = (ca + 2) / 3; // digits in each of the low two thirds
+        int32_t ca2 = ca - 2 * k;
+        int32_t cb2 = cb - 2 * k;
+        int32_t cr = ca + cb;
+        int32_t ce = k + 1;     // evaluations are under 7*BASEX**k
+        int32_t cw = 2 * k + 2; // products of evaluations, with room for a sign
+
+        MANTTYPE* pa1 = pws;
+        MANTTYPE* pam1 = pa1 + ce;
+        MANTTYPE* pam2 = pam1 + ce;
+        MANTTYPE* pb1 = pam2 + ce;
+        MANTTYPE* pbm1 = pb1 + ce;
+        MANTTYPE* pbm2 = pbm1 + ce;
+        MANTTYPE* pw1 = pbm2 + ce;
+        MANTTYPE* pwm1 = pw1 + cw;
+        MANTTYPE* pwm2 = pwm1 + cw;
+        MANTTYPE* pnext = pwm2 + cw;
+
+        // w(0) and w(inf) go straight into the answer, with zeros between.
+        MANTTYPE* pw0 = pr;
+        MANTTYPE* pwinf = pr + 4 * k;
+        int32_t cwinf = ca2 + cb2;
+        mulmant(pw0, pa, k, pb, k, pnext);
+        memset(pr + 2 * k, 0, 2 * k * sizeof(MANTTYPE));
+        mulmant(pwinf, pa + 2 * k, ca2, pb + 2 * k, cb2, pnext);
+
+        pa1[k] = addmant(pa1, pa, k, pa + k, k);
+        addmantto(pa1, ce, pa + 2 * k, ca2);
+        pb1[k] = addmant(pb1, pb, k, pb + k, k);
+        addmantto(pb1, ce, pb + 2 * k, cb2);
+
+        bool anegm1, anegm2, bnegm1, bnegm2;
+        toom3evalneg(pam1, &anegm1, pam2, &anegm2, pa, k, ca2, ce);
+        toom3evalneg(pbm1, &bnegm1, pbm2, &bnegm2, pb, k, cb2, ce);
+
+        mulmant(pw1, pa1, ce, pb1, ce, pnext);
+        mulmant(pwm1, pam1, ce, pbm1, ce, pnext);
+        if (anegm1 != bnegm1)
+        {
+            negmant(pwm1, cw);
+        }
+        mulmant(pwm2, pam2, ce, pbm2, ce, pnext);
+        if (anegm2 != bnegm2)
+        {
+            negmant(pwm2, cw);
+        }
+
+        // r3 = (w(-2) - w(1)) / 3
+        submantfrom(pwm2, cw, pw1, cw);
+        div3mant(pwm2, cw);
+        // r1 = (w(1) - w(-1)) / 2
+        submantfrom(pw1, cw, pwm1, cw);
+        halvemant(pw1, cw);
+        // r2 = w(-1) - w(0)
+        submantfrom(pwm1, cw, pw0, 2 * k);
+        // r3 = (r2 - r3) / 2 + 2 * w(inf)
+        negmant(pwm2, cw);
+        addmantto(pwm2, cw, pwm1, cw);
+        halvemant(pwm2, cw);
+        addmantto(pwm2, cw, pwinf, cwinf);
+        addmantto(pwm2, cw, pwinf, cwinf);
+        // r2 = r2 + r1 - w(inf)
+        addmantto(pwm1, cw, pw1, cw);
+        submantfrom(pwm1, cw, pwinf, cwinf);
+        // r1 = r1 - r3
+        submantfrom(pw1, cw, pwm2, cw);
+
+        addmantto(pr + k, cr - k, pw1, std::min(cw, cr - k));
+        addmantto(pr + 2 * k, cr - 2 * k, pwm1, std::min(cw, cr - 2 * k));
+        addmantto(pr + 3 * k, cr - 3 * k, pwm2, std::min(cw, cr - 3 * k));
+    }
+
+    // pr[0..ca+cb) = pa[0..ca) * pb[0..cb), pws has at least mulscratch(ca, cb)
+    // digits.  pr may not overlap either input.
+    void mulmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, MANTTYPE* pws)
+    {
+        if (ca < cb)
+        {
+            std::swap(pa, pb);
+            std::swap(ca, cb);
+        }
+
+        switch (multier(ca, cb))
+        {
+        case MulTier::Unbalanced:
+            mulunbalanced(pr, pa, ca, pb, cb, pws);
+            break;
+        case MulTier::Karatsuba:
+            mulkaratsuba(pr, pa, ca, pb, cb, pws);
+            break;
+        case MulTier::Toom3:
+            multoom3(pr, pa, ca, pb, cb, pws);
+            break;
+        case MulTier::NTT:
+            mulntt(pr, pa, ca, pb, cb);
+            break;
+        default:
+            mulbasecase(pr, pa, ca, pb, cb);
+            break;
+        }
+    }
+
+    // Karatsuba for a square, the three products are all squares:
+    // a*a = a1*a1*B^2m + ((a0+a1)*(a0+a1) - a0*a0 - a1*a1)*B^m + a0*a0
+    void sqrkaratsuba(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, MANTTYPE* pws)
+    {
+        int32_t m = ca / 2;  // digits in the low half
+        int32_t ch = ca - m; // digits in a1
+        int32_t cr = 2 * ca;
+
+        MANTTYPE* psa = pws;
+        MANTTYPE* pmid = psa + ch + 1;
+        MANTTYPE* pnext = pmid + 2 * (ch + 1);
+
+        sqrmant(pr, pa, m, pnext);
+        sqrmant(pr + 2 * m, pa + m, ch, pnext);
+
+        psa[ch] = addmant(psa, pa + m, ch, pa, m);
+        int32_t cmid = 2 * (ch + 1);
+        sqrmant(pmid, psa, ch + 1, pnext);
+        submantfrom(pmid, cmid, pr, 2 * m);
+        submantfrom(pmid, cmid, pr + 2 * m, cr - 2 * m);
+        addmantto(pr + m, cr - m, pmid, std::min(cmid, cr - m));
+    }
+
+    // Toom-3 for a square, as multoom3 with both operands the same.  The
+    // evaluations at -1 and -2 square to positive numbers whatever their sign.
+    void sqrtoom3(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, MANTTYPE* pws)
+    {
+        int32_t k = (ca + 2) / 3;
+        int32_t ca2 = ca - 2 * k;
+        int32_t cr = 2 * ca;
+        int32_t ce = k + 1;
+        int32_t cw = 2 * k + 2;
+
+        MANTTYPE* pa1 = pws;
+        MANTTYPE* pam1 = pa1 + ce;
+        MANTTYPE* pam2 = pam1 + ce;
+        MANTTYPE* pw1 = pam2 + ce;
+        MANTTYPE* pwm1 = pw1 + cw;
+        MANTTYPE* pwm2 = pwm1 + cw;
+        MANTTYPE* pnext = pwm2 + cw;
+
+        MANTTYPE* pw0 = pr;
+        MANTTYPE* pwinf = pr + 4 * k;
+        int32_t cwinf = 2 * ca2;
+        sqrmant(pw0, pa, k, pnext);
+        memset(pr + 2 * k, 0, 2 * k * sizeof(MANTTYPE));
+        sqrmant(pwinf, pa + 2 * k, ca2, pnext);
+
+        pa1[k] = addmant(pa1, pa, k, pa + k, k);
+        addmantto(pa1, ce, pa + 2 * k, ca2);
+
+        bool anegm1, anegm2;
+        toom3evalneg(pam1, &anegm1, pam2, &anegm2, pa, k, ca2, ce);
+
+        sqrmant(pw1, pa1, ce, pnext);
+        sqrmant(pwm1, pam1, ce, pnext);
+        sqrmant(pwm2, pam2, ce, pnext);
+
+        // Interpolate as in multoom3.
+        submantfrom(pwm2, cw, pw1, cw);
+        div3mant(pwm2, cw);
+        submantfrom(pw1, cw, pwm1, cw);
+        halvemant(pw1, cw);
+        submantfrom(pwm1, cw, pw0, 2 * k);
+        negmant(pwm2, cw);
+        addmantto(pwm2, cw, pwm1, cw);
+        halvemant(pwm2, cw);
+        addmantto(pwm2, cw, pwinf, cwinf);
+        addmantto(pwm2, cw, pwinf, cwinf);
+        addmantto(pwm1, cw, pw1, cw);
+        submantfrom(pwm1, cw, pwinf, cwinf);
+        submantfrom(pw1, cw, pwm2, cw);
+
+        addmantto(pr + k, cr - k, pw1, std::min(cw, cr - k));
+        addmantto(pr + 2 * k, cr - 2 * k, pwm1, std::min(cw, cr - 2 * k));
+        addmantto(pr + 3 * k, cr - 3 * k, pwm2, std::min(cw, cr - 3 * k));
+    }
+
+    // pr[0..2*ca) = pa[0..ca)**2, the same tiers as mulmant with the square
+    // kernels, pws has at least mulscratch(ca, ca) digits.
+    void sqrmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, MANTTYPE* pws)
+    {
+        switch (multier(ca, ca))
+        {
+        case MulTier::Karatsuba:
+            sqrkaratsuba(pr, pa, ca, pws);
+            break;
+        case MulTier::Toom3:
+            sqrtoom3(pr, pa, ca, pws);
+            break;
+        case MulTier::NTT:
+            mulntt(pr, pa, ca, pa, ca);
+            break;
+        default:
+            sqrbasecase(pr, pa, ca);
+            break;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulnumx
+//
+//    ARGUMENTS: pointer to a number and a second number, the
+//               base is always BASEX.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does the number equivalent of *pa *= b.
+//    Assumes the base is BASEX of both numbers.  Short operands use the
+//    same algorithm you learned in grade school, except the base isn't 10
+//    it's BASEX.  Once the shorter operand reaches g_mulKaratsubaThreshold
+//    digits the work is split Karatsuba style, and from g_mulToom3Threshold
+//    digits Toom-3 style, and from g_mulNTTThreshold digits with a number
+//    theoretic transform, all give exactly the grade school answer.  A
+//    number times itself goes to the square kernels, which need about half
+//    the digit products.  A one digit factor is worked in place, in *pa
+//    when it has room.
+//
+//----------------------------------------------------------------------------
+
+void _mulnumx(PNUMBER* pa, PNUMBER b)
+
+{
+    PNUMBER c = nullptr; // c will contain the result.
+    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
+
+    a = *pa;
+
+    if (a != b && (b->cdigit == 1 || a->cdigit == 1))
+    {
+        // A one digit factor scales the other one digit at a time, into a
+        // when it has room for the product.
+        PNUMBER pnumlong = (b->cdigit == 1) ? a : b;
+        TWO_MANTTYPE d = (b->cdigit == 1) ? b->mant[0] : a->mant[0];
+        int32_t cdigits = pnumlong->cdigit;
+        if (a->ccapacity > cdigits)
+        {
+            c = a;
+        }
+        else
+        {
+            createnum(c, growcapacity(a->ccapacity, cdigits + 1));
+        }
+        c->sign = a->sign * b->sign;
+        c->exp = a->exp + b->exp;
+
+        TWO_MANTTYPE cy = 0;
+        for (int32_t i = 0; i < cdigits; i++)
+        {
+            cy += pnumlong->mant[i] * d;
+            c->mant[i] = (MANTTYPE)cy;
+            cy >>= BASEXPWR;
+        }
+        c->mant[cdigits] = (MANTTYPE)cy;
+        c->cdigit = cdigits + 1;
+    }
+    else
+    {
+        createnum(c, a->cdigit + b->cdigit);
+        c->cdigit = a->cdigit + b->cdigit;
+        c->sign = a->sign * b->sign;
+        c->exp = a->exp + b->exp;
+
+        std::vector<MANTTYPE> scratch(mulscratch(a->cdigit, b->cdigit));
+        if (a == b)
+        {
+            sqrmant(c->mant, a->mant, a->cdigit, scratch.data());
+        }
+        else
+        {
+            mulmant(c->mant, a->mant, a->cdigit, b->mant, b->cdigit, scratch.data());
         }
     }
 
@@ -153,9 +939,20 @@ void _mulnumx(PNUMBER* pa, PNUMBER b)
         c->cdigit--;
     }
 
-    destroynum(*pa);
-    *pa = c;
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
+}
+// Bits of the power numpowi32x and ratpowi32 take in one window, for a power
+// of cbits bits.  Each window costs a multiply, and a window of w bits a table
+// of 2**(w-1) odd powers to pick from.
+int32_t powwindow(int32_t cbits)
+{
+    return (cbits <= 8) ? 1 : (cbits <= 24) ? 2 : 3;
 }
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: numpowi32x
@@ -167,32 +964,83 @@ void _mulnumx(PNUMBER* pa, PNUMBER b)
 //
 //    DESCRIPTION: changes numeric representation of root to
 //    root ** power. Assumes base BASEX
-//    decomposes the exponent into it's sums of powers of 2, so on average
-//    it will take n+n/2 multiplies where n is the highest on bit.
+//    Works down the bits of the power with a sliding window, squaring
+//    for each bit and multiplying by an odd power of root from a small
+//    table for each window, so the multiplies are by the short odd powers
+//    rather than the long squares.
 //
 //-----------------------------------------------------------------------------
 
 void numpowi32x(_Inout_ PNUMBER* proot, int32_t power)
 
 {
-    PNUMBER lret = i32tonum(1, BASEX);
+    if (power <= 0)
+    {
+        destroynum(*proot);
+        *proot = i32tonum(1, BASEX);
+        return;
+    }
 
-    // Once the power remaining is zero we are done.
-    while (power > 0)
+    int32_t topbit = 0;
+    while ((power >> topbit) > 1)
     {
-        // If this bit in the power decomposition is on, multiply the result
-        // by the root number.
-        if (power & 1)
+        topbit++;
+    }
+    int32_t cwindow = powwindow(topbit + 1);
+
+    // root, root**3, root**5, ... root**(2**cwindow - 1)
+    std::vector<PNUMBER> odd((size_t)1 << (cwindow - 1));
+    odd[0] = *proot;
+    if (odd.size() > 1)
+    {
+        PNUMBER sqr = nullptr;
+        DUPNUM(sqr, *proot);
+        sqrnumx(&sqr);
+        for (size_t i = 1; i < odd.size(); i++)
         {
-            mulnumx(&lret, *proot);
+            odd[i] = nullptr;
+            DUPNUM(odd[i], odd[i - 1]);
+            mulnumx(&odd[i], sqr);
         }
+        destroynum(sqr);
+    }
 
-        // multiply the root number by itself to scale for the next bit (i.e.
-        // square it.
-        mulnumx(proot, *proot);
+    PNUMBER lret = nullptr;
+    for (int32_t bit = topbit; bit >= 0;)
+    {
+        if (((power >> bit) & 1) == 0)
+        {
+            sqrnumx(&lret);
+            bit--;
+            continue;
+        }
 
-        // move the next bit of the power into place.
-        power >>= 1;
+        // The longest window of at most cwindow bits starting here and
+        // ending in a one.
+        int32_t low = std::max(bit - cwindow + 1, 0);
+        while (((power >> low) & 1) == 0)
+        {
+            low++;
+        }
+        int32_t window = (power >> low) & ((1 << (bit - low + 1)) - 1);
+        if (lret == nullptr)
+        {
+            DUPNUM(lret, odd[window >> 1]);
+        }
+        else
+        {
+            for (int32_t i = low; i <= bit; i++)
+            {
+                sqrnumx(&lret);
+            }
+            mulnumx(&lret, odd[window >> 1]);
+        }
+        bit = low - 1;
+    }
+
+    for (size_t i = 1; i < odd.size(); i++)
+    {
+        destroynum(odd[i]);
     }
     destroynum(*proot);
     *proot = lret;
@@ -224,6 +1072,7 @@ void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision)
         if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 1 || (*pa)->exp != 0)
         {
             // pa and b are both not one.
+            COUNTKERNEL(divnumx, (*pa)->cdigit + b->cdigit);
             _divnumx(pa, b, precision);
         }
         else
@@ -241,6 +1090,230 @@ void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision)
     }
 }
 
+// Digit count from which _divnumx divides recursively (Burnikel and Ziegler)
+// instead of one digit at a time, both the divisor and the quotient have to
+// reach it.  Setting it to INT32_MAX disables the recursive division.  Measured
+// on x64 the recursion pays off from around 48 digits, dividing 2n by n digits
+// it is 1.5x faster at n = 128 and 4x at n = 1024.
+int32_t g_divBZThreshold = 40;
+
+namespace
+{
+    // Shifts pa[0..ca) left by bits (less than BASEXPWR) into pr[0..ca) and
+    // returns the bits shifted out of the top.
+    MANTTYPE shlmant(MANTTYPE* pr, const MANTTYPE* pa, int32_t ca, int32_t bits)
+    {
+        MANTTYPE out = 0;
+        for (int32_t i = 0; i < ca; i++)
+        {
+            TWO_MANTTYPE t = ((TWO_MANTTYPE)pa[i] << bits) | out;
+            pr[i] = (MANTTYPE)(t & MANTMASK);
+            out = (MANTTYPE)(t >> BASEXPWR);
+        }
+        return out;
+    }
+
+    // Knuth's algorithm D.  Divides pu[0..cu] (cu digits plus a top digit that
+    // is zero or small) by pv[0..cv), cv >= 2, whose top digit has its high bit
+    // set.  The cu - cv + 1 quotient digits go in pq, the remainder is left in
+    // pu[0..cv).  The low czero digits of pu are known to be zero, which lets
+    // the division stop as soon as nothing is left.
+    void divknuth(MANTTYPE* pq, MANTTYPE* pu, int32_t cu, const MANTTYPE* pv, int32_t cv, int32_t czero)
+    {
+        TWO_MANTTYPE vtop = pv[cv - 1];
+        TWO_MANTTYPE vnext = pv[cv - 2];
+
+        for (int32_t j = cu - cv; j >= 0; j--)
+        {
+            // Estimate the quotient digit from the top two digits, this is at
+            // most two too large, and the test against the third digit catches
+            // almost all of those.
+            TWO_MANTTYPE num = ((TWO_MANTTYPE)pu[j + cv] << BASEXPWR) | pu[j + cv - 1];
+            TWO_MANTTYPE qhat = num / vtop;
+            TWO_MANTTYPE rhat = num % vtop;
+            while (qhat >= BASEX || qhat * vnext > ((rhat << BASEXPWR) | pu[j + cv - 2]))
+            {
+                qhat--;
+                rhat += vtop;
+                if (rhat >= BASEX)
+                {
+                    break;
+                }
+            }
+
+            // pu[j..j+cv] -= qhat * pv
+            int64_t borrow = 0;
+            int64_t t;
+            for (int32_t i = 0; i < cv; i++)
+            {
+                TWO_MANTTYPE p = qhat * pv[i];
+                t = (int64_t)pu[i + j] - borrow - (int64_t)(p & MANTMASK);
+                pu[i + j] = (MANTTYPE)(t & MANTMASK);
+                borrow = (int64_t)(p >> BASEXPWR) - (t >> BASEXPWR);
+            }
+            t = (int64_t)pu[j + cv] - borrow;
+            pu[j + cv] = (MANTTYPE)(t & MANTMASK);
+
+            if (t < 0)
+            {
+                // Rarely the estimate is still one too big, add pv back.
+                qhat--;
+                MANTTYPE cy = addmant(pu + j, pu + j, cv, pv, cv);
+                pu[j + cv] = (MANTTYPE)((pu[j + cv] + cy) & MANTMASK);
+            }
+            pq[j] = (MANTTYPE)qhat;
+
+            if (j <= czero && pu[j + cv - 1] == 0)
+            {
+                int32_t i = j + cv - 1;
+                while (i > j && pu[i - 1] == 0)
+                {
+                    i--;
+                }
+                if (i == j)
+                {
+                    // Nothing left to divide, the remaining digits are zero.
+                    memset(pq, 0, j * sizeof(MANTTYPE));
+                    return;
+                }
+            }
+        }
+    }
+
+    // Recursive division of Burnikel and Ziegler, in the form of Brent and
+    // Zimmermann's RecursiveDivRem.  Divides pu[0..n+m) by the normalized
+    // pv[0..n), m <= n, pu[n+m] must be zero and pu[m..n+m) no larger than
+    // pv[0..n) for the guesses below to hold.  The m + 1 quotient digits go in
+    // pq, the remainder is left in pu[0..n) and pu[n..n+m] ends up zero.  The
+    // work is split into two halves each costing one smaller division and one
+    // multiplication, so it runs at the speed of the fast multiply.
+    void divbz(MANTTYPE* pq, MANTTYPE* pu, int32_t n, int32_t m, const MANTTYPE* pv)
+    {
+        if (m < g_divBZThreshold || m < 2)
+        {
+            divknuth(pq, pu, n + m, pv, n, 0);
+            return;
+        }
+
+        int32_t k = m / 2;
+        const MANTTYPE* pv1 = pv + k; // top n - k digits of the divisor
+        const MANTTYPE one = 1;
+        int32_t cwin; // digits in the window being corrected
+
+        std::vector<MANTTYPE> prod(m + 1);
+        std::vector<MANTTYPE> q0(k + 1);
+        std::vector<MANTTYPE> scratch(mulscratch(m - k + 1, k));
+
+        // High half: divide the top n + m - 2k digits by the top of the
+        // divisor, then take the rest of the divisor off what remains.  The
+        // first guess is at most two too large.
+        divbz(pq + k, pu + 2 * k, n - k, m - k, pv1);
+        mulmant(prod.data(), pq + k, m - k + 1, pv, k, scratch.data());
+        cwin = n + m + 1 - k;
+        bool negative = submantfrom(pu + k, cwin, prod.data(), m + 1);
+        while (negative)
+        {
+            submantfrom(pq + k, m - k + 1, &one, 1);
+            negative = !addmantto(pu + k, cwin, pv, n);
+        }
+
+        // Low half, the same with the n + k digits left over.
+        divbz(q0.data(), pu + k, n - k, k, pv1);
+        mulmant(prod.data(), q0.data(), k + 1, pv, k, scratch.data());
+        cwin = n + k + 1;
+        negative = submantfrom(pu, cwin, prod.data(), 2 * k + 1);
+        while (negative)
+        {
+            submantfrom(q0.data(), k + 1, &one, 1);
+            negative = !addmantto(pu, cwin, pv, n);
+        }
+
+        memcpy(pq, q0.data(), k * sizeof(MANTTYPE));
+        addmantto(pq + k, m - k + 1, q0.data() + k, 1);
+    }
+
+    // Divides pu[0..cu] by the normalized pv[0..cv) with pu[cu+1] zero, long
+    // divisors recursively, leaving the same cu - cv + 1 quotient digits and
+    // remainder as divknuth.  Quotients longer than the divisor are done a
+    // divisor length of digits at a time.  Taking the windows from the zero
+    // digit down keeps each one below BASEX**mpart * pv, else the top digit
+    // pu[cu] could leave divbz far more than two corrections to make.
+    void divrecursive(MANTTYPE* pq, MANTTYPE* pu, int32_t cu, const MANTTYPE* pv, int32_t cv)
+    {
+        int32_t m = cu + 1 - cv;
+        std::vector<MANTTYPE> qpart(std::min(m, cv) + 1);
+
+        while (m > 0)
+        {
+            int32_t mpart = std::min(m, cv);
+            m -= mpart;
+            divbz(qpart.data(), pu + m, cv, mpart, pv);
+
+            // qpart[mpart] is zero, the window is less than BASEX**mpart * pv.
+            memcpy(pq + m, qpart.data(), mpart * sizeof(MANTTYPE));
+        }
+    }
+
+    // Puts the cu - cb + 1 digits of floor(pa * BASEX**cshift / pb) in pq, with
+    // cu = ca + cshift >= cb and pb[cb-1] != 0.  Returns true when the division
+    // leaves no remainder.  For a one digit pb, pq may be pa.
+    bool divmantx(MANTTYPE* pq, const MANTTYPE* pa, int32_t ca, int32_t cshift, const MANTTYPE* pb, int32_t cb)
+    {
+        int32_t cu = ca + cshift;
+
+        if (cb == 1)
+        {
+            // Short division, the shifted in zeros only bring down the remainder.
+            TWO_MANTTYPE v = pb[0];
+            TWO_MANTTYPE rem = 0;
+            for (int32_t j = cu - 1; j >= 0; j--)
+            {
+                if (rem == 0 && j < cshift)
+                {
+                    memset(pq, 0, (j + 1) * sizeof(MANTTYPE));
+                    break;
+                }
+                rem = (rem << BASEXPWR) | (j >= cshift ? pa[j - cshift] : 0);
+                pq[j] = (MANTTYPE)(rem / v);
+                rem %= v;
+            }
+            return rem == 0;
+        }
+
+        // Normalize so the divisor's top digit has its high bit set, both
+        // numbers share one scratch buffer.
+        int32_t bits = 0;
+        for (MANTTYPE top = pb[cb - 1]; (top & (BASEX >> 1)) == 0; top <<= 1)
+        {
+            bits++;
+        }
+
+        std::vector<MANTTYPE> scratch(cu + 2 + cb);
+        MANTTYPE* pu = scratch.data();
+        MANTTYPE* pv = pu + cu + 2;
+        pu[cu] = shlmant(pu + cshift, pa, ca, bits);
+        shlmant(pv, pb, cb, bits);
+
+        if (cb >= g_divBZThreshold && cu - cb >= g_divBZThreshold)
+        {
+            divrecursive(pq, pu, cu, pv, cb);
+        }
+        else
+        {
+            divknuth(pq, pu, cu, pv, cb, cshift);
+        }
+
+        for (int32_t i = 0; i < cb; i++)
+        {
+            if (pu[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 //    FUNCTION: _divnumx
@@ -250,21 +1323,19 @@ void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa /= b.
-//    Assumes radix is the internal radix representation.
+//    Assumes radix is the internal radix representation.  Long division
+//    one BASEX digit at a time, guessing each digit from the leading digits
+//    (Knuth's algorithm D), stopping early if the remainder runs out.
 //
 //----------------------------------------------------------------------------
 
 void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
 
 {
-    PNUMBER a = nullptr;       // a is the dereferenced number pointer from *pa
-    PNUMBER c = nullptr;       // c will contain the result.
-    PNUMBER lasttmp = nullptr; // lasttmp allows a backup when the algorithm
-                               // guesses one bit too far.
-    PNUMBER tmp = nullptr;     // current guess being worked on for divide.
-    PNUMBER rem = nullptr;     // remainder after applying guess.
-    int32_t cdigits;           // count of digits for answer.
-    MANTTYPE* ptrc;            // ptrc is a pointer to the mantissa of c.
+    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
+    PNUMBER c = nullptr; // c will contain the result.
+    int32_t cdigits;     // count of digits for answer.
+    MANTTYPE* ptrc;      // ptrc is a pointer to the mantissa of c.
 
     int32_t thismax = precision + g_ratio; // set a maximum number of internal digits
                                            // to shoot for in the divide.
@@ -284,55 +1355,40 @@ void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
         thismax = b->cdigit;
     }
 
-    // Create c (the divide answer) and set up exponent and sign.
-    createnum(c, thismax + 1);
-    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
-    c->sign = a->sign * b->sign;
-
-    ptrc = c->mant + thismax;
-    cdigits = 0;
+    // Create c (the divide answer) and set up exponent and sign.  A one digit
+    // divisor is divided out of a in place when it has room, the short
+    // division writes each quotient digit after the digits of a at and above
+    // it have been read.
+    int32_t cexp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
+    int32_t csign = a->sign * b->sign;
+    if (b->cdigit == 1 && a != b && a->ccapacity > thismax)
+    {
+        c = a;
+    }
+    else
+    {
+        createnum(c, thismax + 1);
+    }
 
-    DUPNUM(rem, a);
-    rem->sign = b->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
+    // Line the top of a up with the top of b and shift in enough zeros for
+    // thismax quotient digits.
+    bool exact = divmantx(c->mant, a->mant, a->cdigit, b->cdigit - a->cdigit + thismax - 1, b->mant, b->cdigit);
+    c->exp = cexp;
+    c->sign = csign;
 
-    while (cdigits++ < thismax && !zernum(rem))
+    cdigits = thismax;
+    ptrc = c->mant;
+    if (exact)
     {
-        int32_t digit = 0;
-        *ptrc = 0;
-        while (!lessnum(rem, b))
+        // The long hand division would have stopped at the last nonzero
+        // digit.
+        while (cdigits > 0 && *ptrc == 0)
         {
-            digit = 1;
-            DUPNUM(tmp, b);
-            destroynum(lasttmp);
-            lasttmp = i32tonum(0, BASEX);
-            while (lessnum(tmp, rem))
-            {
-                destroynum(lasttmp);
-                DUPNUM(lasttmp, tmp);
-                addnum(&tmp, tmp, BASEX);
-                digit *= 2;
-            }
-            if (lessnum(rem, tmp))
-            {
-                // too far, back up...
-                destroynum(tmp);
-                digit /= 2;
-                tmp = lasttmp;
-                lasttmp = nullptr;
-            }
-
-            tmp->sign *= -1;
-            addnum(&rem, tmp, BASEX);
-            destroynum(tmp);
-            destroynum(lasttmp);
-            *ptrc |= digit;
+            ptrc++;
+            cdigits--;
         }
-        rem->exp++;
-        ptrc--;
     }
-    cdigits--;
-    if (c->mant != ++ptrc)
+    if (c->mant != ptrc)
     {
         memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
     }
@@ -355,8 +1411,202 @@ void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
         }
     }
 
-    destroynum(rem);
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
+}
+
+namespace
+{
+    // Drops the digits after the point of a number that is not negative.
+    void truncnumx(PNUMBER pnum)
+    {
+        if (pnum->exp < 0)
+        {
+            int32_t cdrop = -pnum->exp;
+            if (cdrop >= pnum->cdigit)
+            {
+                pnum->cdigit = 1;
+                pnum->mant[0] = 0;
+            }
+            else
+            {
+                pnum->cdigit -= cdrop;
+                memmove(pnum->mant, pnum->mant + cdrop, pnum->cdigit * sizeof(MANTTYPE));
+            }
+            pnum->exp = 0;
+        }
+    }
+
+    // floor(a / b) for positive integers with exponents that are not
+    // negative.  Unlike divnumx only the digits of the quotient are worked
+    // out.
+    PNUMBER intdivnumx(PNUMBER a, PNUMBER b)
+    {
+        const MANTTYPE* pa = a->mant;
+        int32_t ca = a->cdigit;
+        int32_t cshift = a->exp - b->exp;
+        if (cshift < 0)
+        {
+            // The digits of a below the last of b can't reach the quotient.
+            pa -= cshift;
+            ca += cshift;
+            cshift = 0;
+        }
+        if (ca + cshift < b->cdigit)
+        {
+            return i32tonum(0, BASEX);
+        }
+
+        PNUMBER q = nullptr;
+        createnum(q, ca + cshift - b->cdigit + 1);
+        q->sign = 1;
+        q->exp = 0;
+        q->cdigit = ca + cshift - b->cdigit + 1;
+        divmantx(q->mant, pa, ca, cshift, b->mant, b->cdigit);
+        while (q->cdigit > 1 && q->mant[q->cdigit - 1] == 0)
+        {
+            q->cdigit--;
+        }
+        return q;
+    }
+
+    // A number no smaller than the integer nth root of a, which has at most
+    // two digits, good to about 40 bits.
+    PNUMBER estimaterootx(PNUMBER a, int32_t n)
+    {
+        int32_t ctop = std::min(a->cdigit, 3);
+        double top = 0;
+        for (int32_t i = a->cdigit - 1; i >= a->cdigit - ctop; i--)
+        {
+            top = std::ldexp(top, BASEXPWR) + a->mant[i];
+        }
+        double est = std::exp2((std::log2(top) + (double)BASEXPWR * (a->cdigit - ctop)) / n);
+        est += std::ldexp(est, -40) + 2;
+
+        TWO_MANTTYPE root = (est < std::ldexp(1.0, 2 * BASEXPWR)) ? (TWO_MANTTYPE)est : UINT64_MAX;
+        PNUMBER pret = nullptr;
+        createnum(pret, 2);
+        pret->sign = 1;
+        pret->exp = 0;
+        pret->mant[0] = (MANTTYPE)(root & (BASEX - 1));
+        pret->mant[1] = (MANTTYPE)(root >> BASEXPWR);
+        pret->cdigit = (pret->mant[1] != 0) ? 2 : 1;
+        return pret;
+    }
+
+    // The integer nth root of a, and whether it is exact.  a is a positive
+    // integer written out without an exponent.
+    PNUMBER introotx(PNUMBER a, int32_t n, bool& fexact)
+    {
+        PNUMBER r = nullptr;
+        int32_t k = a->cdigit / (2 * n);
+        if (k == 0)
+        {
+            r = estimaterootx(a, n);
+        }
+        else
+        {
+            // The root of the leading digits of a has the leading half of the
+            // digits of the root of a.  Rounded up and grown by k digits it is
+            // no smaller than the root of a.
+            PNUMBER ahigh = nullptr;
+            createnum(ahigh, a->cdigit - n * k);
+            ahigh->sign = 1;
+            ahigh->exp = 0;
+            ahigh->cdigit = a->cdigit - n * k;
+            memcpy(ahigh->mant, a->mant + n * k, ahigh->cdigit * sizeof(MANTTYPE));
+            bool fhighexact;
+            r = introotx(ahigh, n, fhighexact);
+            destroynum(ahigh);
+            addnum(&r, num_one, BASEX);
+            r->exp += k;
+        }
+
+        // From above Newton's iteration r = ((n - 1) * r + a / r**(n-1)) / n
+        // falls until it reaches the root, each step doubles the digits that
+        // are right.
+        PNUMBER nless1 = i32tonum(n - 1, BASEX);
+        PNUMBER nnum = i32tonum(n, BASEX);
+        PNUMBER rpow = nullptr;
+        while (true)
+        {
+            DUPNUM(rpow, r);
+            if (n > 2)
+            {
+                numpowi32x(&rpow, n - 1);
+            }
+            PNUMBER q = intdivnumx(a, rpow);
+            PNUMBER next = nullptr;
+            DUPNUM(next, r);
+            mulnumx(&next, nless1);
+            addnum(&next, q, BASEX);
+            destroynum(q);
+            q = intdivnumx(next, nnum);
+            destroynum(next);
+            next = q;
+
+            if (!lessnum(next, r))
+            {
+                destroynum(next);
+                break;
+            }
+            destroynum(r);
+            r = next;
+        }
+
+        mulnumx(&rpow, r);
+        fexact = equnum(rpow, a);
+
+        destroynum(rpow);
+        destroynum(nnum);
+        destroynum(nless1);
+        return r;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: rootnumx
+//
+//    ARGUMENTS: pointer to a number that is not negative, root to take.
+//
+//    RETURN: true if the root is exact, root is changed.
+//
+//    DESCRIPTION: changes numeric representation of the integer part of
+//    the number to its integer nth root.  Assumes base BASEX.
+//    The root of the leading digits is taken first, that gives half the
+//    digits of the root, and Newton's iteration on the whole number
+//    doubles them.  Most of the work is done at the full length.
+//
+//-----------------------------------------------------------------------------
+
+bool rootnumx(_Inout_ PNUMBER* pa, int32_t n)
+
+{
+    PNUMBER a = *pa;
+    truncnumx(a);
+    if (n == 1 || (a->cdigit == 1 && a->exp == 0 && a->mant[0] <= 1))
+    {
+        // zero and one are their own roots.
+        return true;
+    }
+
+    // Write the trailing zeros out, the leading digits are taken off a
+    // number with no exponent.
+    PNUMBER aint = nullptr;
+    createnum(aint, a->cdigit + a->exp);
+    aint->sign = 1;
+    aint->exp = 0;
+    aint->cdigit = a->cdigit + a->exp;
+    memcpy(aint->mant + a->exp, a->mant, a->cdigit * sizeof(MANTTYPE));
 
+    bool fexact;
+    PNUMBER r = introotx(aint, n, fexact);
+    destroynum(aint);
     destroynum(*pa);
-    *pa = c;
+    *pa = r;
+    return fexact;
 }
@@ -21,6 +21,7 @@
 #include "winerror_cross_platform.h"
 #include <sstream>
 #include <cstring> // for memmove, memcpy
+#include <vector>
 #include "ratpak.h"
 
 using namespace std;
@@ -116,6 +117,253 @@ void* zmalloc(size_t a)
     return calloc(a, sizeof(unsigned char));
 }
 
+#if RATPAK_TELEMETRY
+thread_local RATPAKSTATS g_ratpakstats;
+#endif
+
+namespace
+{
+    void* heapalloc(uint32_t cb)
+    {
+        void* p = zmalloc(cb);
+        if (p == nullptr)
+        {
+            throw(CALC_E_OUTOFMEMORY);
+        }
+#if RATPAK_TELEMETRY
+        g_ratpakstats.cmalloc++;
+        g_ratpakstats.cbmalloc += cb;
+#endif
+        return p;
+    }
+
+    void heapfree(void* p)
+    {
+        free(p);
+#if RATPAK_TELEMETRY
+        g_ratpakstats.cfree++;
+#endif
+    }
+
+#if RATPAK_POOL
+    // Numbers are pooled by the power of two their digit count rounds up to,
+    // from 2**MINPOOLCLASS up to 2**MAXPOOLCLASS digits.  Rationals have a
+    // list of their own, and longer numbers go straight to the heap.
+    constexpr uint32_t MINPOOLCLASS = 2;
+    constexpr uint32_t MAXPOOLCLASS = 12;
+    constexpr uint32_t RATCLASS = MAXPOOLCLASS + 1;
+    constexpr uint32_t NOCLASS = MAXPOOLCLASS + 2;
+    constexpr uint32_t MAXPOOLBLOCKS = 64; // blocks kept on each list
+
+    // Every block starts with this header, the NUMBER or RAT follows it.
+    typedef struct _poolheader
+    {
+        struct _poolheader* pnext; // next free block on the same list
+        uintptr_t sizeclass;
+    } POOLHEADER;
+
+    typedef struct _freelists
+    {
+        POOLHEADER* pfree[RATCLASS + 1];
+        uint32_t cfree[RATCLASS + 1];
+        int32_t cscope;   // RatpakPoolScopes alive on the thread
+        bool fregistered; // g_poolreleaser empties the lists when the thread ends
+        bool fclosed;     // the thread is ending, blocks go back to the heap
+    } FREELISTS;
+
+    thread_local FREELISTS g_freelists;
+
+    struct POOLRELEASER
+    {
+        ~POOLRELEASER()
+        {
+            releasepool();
+            g_freelists.fclosed = true;
+        }
+    };
+
+    thread_local POOLRELEASER g_poolreleaser;
+
+    uint32_t numclass(uint32_t cdigit)
+    {
+        uint32_t sizeclass = MINPOOLCLASS;
+        while (sizeclass <= MAXPOOLCLASS && (1u << sizeclass) < cdigit)
+        {
+            sizeclass++;
+        }
+        return sizeclass <= MAXPOOLCLASS ? sizeclass : NOCLASS;
+    }
+
+    //-----------------------------------------------------------------------------
+    //
+    //    FUNCTION: poolalloc
+    //
+    //    ARGUMENTS: size class of the block, bytes needed by the caller
+    //
+    //    RETURN: pointer to cb zeroed bytes
+    //
+    //    DESCRIPTION: hands out a free block of the class if the thread has
+    //    one, otherwise takes a block big enough for the whole class from the
+    //    heap.
+    //
+    //-----------------------------------------------------------------------------
+
+    void* poolalloc(uint32_t sizeclass, uint32_t cb)
+    {
+        POOLHEADER* phdr = nullptr;
+        if (sizeclass != NOCLASS && g_freelists.pfree[sizeclass] != nullptr)
+        {
+            phdr = g_freelists.pfree[sizeclass];
+            g_freelists.pfree[sizeclass] = phdr->pnext;
+            g_freelists.cfree[sizeclass]--;
+#if RATPAK_TELEMETRY
+            g_ratpakstats.creuse++;
+#endif
+            memset(phdr + 1, 0, cb);
+        }
+        else
+        {
+            uint32_t cbblock = cb;
+            if (sizeclass < RATCLASS)
+            {
+                cbblock = (uint32_t)(sizeof(NUMBER) + (1u << sizeclass) * sizeof(MANTTYPE));
+            }
+            if (FAILED(Calc_ULongAdd(cbblock, sizeof(POOLHEADER), &cbblock)))
+            {
+                throw(CALC_E_INVALIDRANGE);
+            }
+            phdr = (POOLHEADER*)heapalloc(cbblock);
+        }
+        phdr->pnext = nullptr;
+        phdr->sizeclass = sizeclass;
+        return phdr + 1;
+    }
+
+    void poolfree(void* p)
+    {
+        POOLHEADER* phdr = (POOLHEADER*)p - 1;
+        uintptr_t sizeclass = phdr->sizeclass;
+        if (sizeclass == NOCLASS || g_freelists.fclosed || g_freelists.cfree[sizeclass] >= MAXPOOLBLOCKS)
+        {
+            heapfree(phdr);
+            return;
+        }
+        if (!g_freelists.fregistered)
+        {
+            // Touching the releaser arranges for its destructor to run when
+            // the thread ends.
+            g_freelists.fregistered = true;
+            (void)&g_poolreleaser;
+        }
+        phdr->pnext = g_freelists.pfree[sizeclass];
+        g_freelists.pfree[sizeclass] = phdr;
+        g_freelists.cfree[sizeclass]++;
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: releasepool
+//
+//    ARGUMENTS: none
+//
+//    RETURN: None
+//
+//    DESCRIPTION: Gives the blocks on the free lists of the calling thread
+//    back to the heap.
+//
+//-----------------------------------------------------------------------------
+
+void releasepool()
+{
+#if RATPAK_POOL
+    for (uint32_t sizeclass = 0; sizeclass <= RATCLASS; sizeclass++)
+    {
+        while (g_freelists.pfree[sizeclass] != nullptr)
+        {
+            POOLHEADER* phdr = g_freelists.pfree[sizeclass];
+            g_freelists.pfree[sizeclass] = phdr->pnext;
+            heapfree(phdr);
+        }
+        g_freelists.cfree[sizeclass] = 0;
+    }
+#endif
+}
+
+RATPAKSTATS getratpakstats()
+{
+#if RATPAK_TELEMETRY
+    return g_ratpakstats;
+#else
+    return RATPAKSTATS{};
+#endif
+}
+
+void resetratpakstats()
+{
+#if RATPAK_TELEMETRY
+    int64_t clivenum = g_ratpakstats.clivenum;
+    g_ratpakstats = RATPAKSTATS{};
+    g_ratpakstats.clivenum = clivenum;
+    g_ratpakstats.cpeaknum = clivenum;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: ratpakstatstojson
+//
+//    ARGUMENTS: counters from getratpakstats
+//
+//    RETURN: the counters as a JSON object on one line
+//
+//    DESCRIPTION: names every counter of RATPAKSTATS so a trace can carry a
+//    snapshot as it is, "enabled" tells whether the build counts at all.
+//
+//-----------------------------------------------------------------------------
+
+std::string ratpakstatstojson(const RATPAKSTATS& stats)
+{
+    static const char* const seriesnames[TAYLOR_COUNT] = { "exp", "log", "sin", "cos", "sinh", "cosh", "asin", "acos", "atan", "asinh", "atanh", "pi" };
+
+    stringstream json;
+    auto kernel = [&json](const char* name, const KERNELSTATS& kernelstats) {
+        json << "\"" << name << "\":{\"calls\":" << kernelstats.ccall << ",\"digits\":" << kernelstats.cdigit << "},";
+    };
+
+    json << "{\"enabled\":" << (RATPAK_TELEMETRY ? "true" : "false") << ",";
+    kernel("mulnumx", stats.mulnumx);
+    kernel("divnumx", stats.divnumx);
+    kernel("addnum", stats.addnum);
+    kernel("trimit", stats.trimit);
+    json << "\"heapblocks\":" << stats.cmalloc << ",\"heapbytes\":" << stats.cbmalloc << ",\"freedblocks\":" << stats.cfree;
+    json << ",\"reusedblocks\":" << stats.creuse << ",\"livenumbers\":" << stats.clivenum << ",\"peaknumbers\":" << stats.cpeaknum << ",\"taylorterms\":{";
+    for (int series = 0; series < TAYLOR_COUNT; series++)
+    {
+        json << (series == 0 ? "" : ",") << "\"" << seriesnames[series] << "\":" << stats.cterm[series];
+    }
+    json << "}}";
+    return json.str();
+}
+
+RatpakPoolScope::RatpakPoolScope()
+{
+#if RATPAK_POOL
+    g_freelists.cscope++;
+#endif
+}
+
+RatpakPoolScope::~RatpakPoolScope()
+{
+#if RATPAK_POOL
+    if (--g_freelists.cscope == 0)
+    {
+        releasepool();
+    }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: _dupnum
@@ -130,7 +378,16 @@ void* zmalloc(size_t a)
 
 void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src)
 {
-    memcpy(dest, src, (int)(sizeof(NUMBER) + ((src)->cdigit) * (sizeof(MANTTYPE))));
+    if (dest != src)
+    {
+        // dest keeps its own capacity, DUPNUM has made sure it is enough for
+        // the digits of src and the zero after them.
+        dest->sign = src->sign;
+        dest->cdigit = src->cdigit;
+        dest->exp = src->exp;
+        memcpy(dest->mant, src->mant, (int)((src->cdigit) * (sizeof(MANTTYPE))));
+        dest->mant[src->cdigit] = 0;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -150,7 +407,14 @@ void _destroynum(_Frees_ptr_opt_ PNUMBER pnum)
 {
     if (pnum != nullptr)
     {
-        free(pnum);
+#if RATPAK_TELEMETRY
+        g_ratpakstats.clivenum--;
+#endif
+#if RATPAK_POOL
+        poolfree(pnum);
+#else
+        heapfree(pnum);
+#endif
     }
 }
 
@@ -174,7 +438,11 @@ void _destroyrat(_Frees_ptr_opt_ PRAT prat)
     {
         destroynum(prat->pp);
         destroynum(prat->pq);
-        free(prat);
+#if RATPAK_POOL
+        poolfree(prat);
+#else
+        heapfree(prat);
+#endif
     }
 }
 
@@ -193,24 +461,77 @@ void _destroyrat(_Frees_ptr_opt_ PRAT prat)
 PNUMBER _createnum(_In_ uint32_t size)
 
 {
-    PNUMBER pnumret = nullptr;
     uint32_t cbAlloc;
 
     // sizeof( MANTTYPE ) is the size of a 'digit'
     if (SUCCEEDED(Calc_ULongAdd(size, 1, &cbAlloc)) && SUCCEEDED(Calc_ULongMult(cbAlloc, sizeof(MANTTYPE), &cbAlloc))
         && SUCCEEDED(Calc_ULongAdd(cbAlloc, sizeof(NUMBER), &cbAlloc)))
     {
-        pnumret = (PNUMBER)zmalloc(cbAlloc);
-        if (pnumret == nullptr)
-        {
-            throw(CALC_E_OUTOFMEMORY);
-        }
+#if RATPAK_POOL
+        uint32_t sizeclass = numclass(size + 1);
+        PNUMBER pnumret = (PNUMBER)poolalloc(sizeclass, cbAlloc);
+        pnumret->ccapacity = (int32_t)((sizeclass == NOCLASS) ? size + 1 : 1u << sizeclass);
+#else
+        PNUMBER pnumret = (PNUMBER)heapalloc(cbAlloc);
+        pnumret->ccapacity = (int32_t)(size + 1);
+#endif
+#if RATPAK_TELEMETRY
+        g_ratpakstats.cpeaknum = max(g_ratpakstats.cpeaknum, ++g_ratpakstats.clivenum);
+#endif
+        return (pnumret);
     }
-    else
+    throw(CALC_E_INVALIDRANGE);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: growcapacity
+//
+//    ARGUMENTS: digits of room a number has, digits it has to grow to
+//
+//    RETURN: size to create the grown number with
+//
+//    DESCRIPTION: Grows the room at least half again, so a number that keeps
+//    outgrowing itself is only moved a logarithmic number of times.
+//
+//-----------------------------------------------------------------------------
+
+int32_t growcapacity(int32_t ccapacity, int32_t cdigit)
+{
+    return max(cdigit, (int32_t)min<int64_t>(ccapacity + ccapacity / 2, INT32_MAX - 1));
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: alignnum
+//
+//    ARGUMENTS: pointer to a number, an exponent no more than its own, and
+//    the digits it is to have room for
+//
+//    RETURN: true if the number has the room and was lined up
+//
+//    DESCRIPTION: Moves the digits of the number up so its exponent becomes
+//    exp, padding below them with zeros, when it has room for cdigit digits.
+//    The value doesn't change, and the number is left alone if it hasn't got
+//    the room.
+//
+//-----------------------------------------------------------------------------
+
+bool alignnum(_Inout_ PNUMBER pnum, int32_t exp, int32_t cdigit)
+{
+    if (pnum->ccapacity < cdigit)
     {
-        throw(CALC_E_INVALIDRANGE);
+        return false;
     }
-    return (pnumret);
+    int32_t cshift = pnum->exp - exp;
+    if (cshift > 0)
+    {
+        memmove(pnum->mant + cshift, pnum->mant, pnum->cdigit * sizeof(MANTTYPE));
+        memset(pnum->mant, 0, cshift * sizeof(MANTTYPE));
+        pnum->cdigit += cshift;
+        pnum->exp = exp;
+    }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -230,14 +551,11 @@ PNUMBER _createnum(_In_ uint32_t size)
 PRAT _createrat(void)
 
 {
-    PRAT prat = nullptr;
-
-    prat = (PRAT)zmalloc(sizeof(RAT));
-
-    if (prat == nullptr)
-    {
-        throw(CALC_E_OUTOFMEMORY);
-    }
+#if RATPAK_POOL
+    PRAT prat = (PRAT)poolalloc(RATCLASS, sizeof(RAT));
+#else
+    PRAT prat = (PRAT)heapalloc(sizeof(RAT));
+#endif
     prat->pp = nullptr;
     prat->pq = nullptr;
     return (prat);
@@ -286,6 +604,210 @@ PRAT numtorat(_In_ PNUMBER pin, uint32_t radix)
     return (pout);
 }
 
+// Digit count from which nRadixxtonum and numtonRadixx split numbers around
+// powers of the radix and convert the halves separately, instead of working
+// through them a chunk at a time.  Counted in BASEX digits, or in chunks of
+// radix digits that fit one BASEX digit.  Setting it to INT32_MAX disables the
+// splitting.
+int32_t g_convDCThreshold = 48;
+
+namespace
+{
+    // The most radix digits whose value still fits in one BASEX digit, the
+    // conversions work on chunks of that many digits.  Their largest value plus
+    // one goes in *pchunkpower.
+    int32_t chunkdigits(uint32_t radix, MANTTYPE* pchunkpower)
+    {
+        int32_t cchunk = 0;
+        TWO_MANTTYPE power = 1;
+        while (power * radix < BASEX)
+        {
+            power *= radix;
+            cchunk++;
+        }
+        *pchunkpower = (MANTTYPE)power;
+        return cchunk;
+    }
+
+    // radix ** (cchunk * 2 ** level) in BASEX.  The table is kept between calls
+    // since the display keeps converting to the same radix, and it is rebuilt
+    // when the radix changes.
+    uint32_t powersradix = 0;
+    vector<PNUMBER> powers;
+
+    PNUMBER radixpower(uint32_t radix, size_t level)
+    {
+        if (radix != powersradix)
+        {
+            for (auto& power : powers)
+            {
+                destroynum(power);
+            }
+            powers.clear();
+            powersradix = radix;
+        }
+
+        while (powers.size() <= level)
+        {
+            PNUMBER power = nullptr;
+            if (powers.empty())
+            {
+                MANTTYPE chunkpower;
+                chunkdigits(radix, &chunkpower);
+                power = Ui32tonum(chunkpower, BASEX);
+            }
+            else
+            {
+                DUPNUM(power, powers.back());
+                sqrnumx(&power);
+            }
+            powers.push_back(power);
+        }
+        return powers[level];
+    }
+
+    // Converts the radix digits pd[0..cd) into an integer in BASEX.
+    PNUMBER radixtox(const MANTTYPE* pd, int32_t cd, uint32_t radix)
+    {
+        MANTTYPE chunkpower;
+        int32_t cchunk = chunkdigits(radix, &chunkpower);
+        int32_t cchunks = (cd + cchunk - 1) / cchunk;
+
+        if (cchunks <= g_convDCThreshold || cchunks < 2)
+        {
+            // Horner's rule on whole chunks, from the top.  The top chunk is
+            // the one that may be short.
+            PNUMBER x = nullptr;
+            createnum(x, cchunks + 1);
+            x->sign = 1;
+            x->exp = 0;
+            int32_t cx = 0;
+            for (int32_t id = cd; id > 0;)
+            {
+                TWO_MANTTYPE cy = 0;
+                TWO_MANTTYPE scale = 1;
+                for (int32_t ctake = (id - 1) % cchunk + 1; ctake > 0; ctake--)
+                {
+                    cy = cy * radix + pd[--id];
+                    scale *= radix;
+                }
+
+                for (int32_t i = 0; i < cx; i++)
+                {
+                    cy += x->mant[i] * scale;
+                    x->mant[i] = (MANTTYPE)(cy & (BASEX - 1));
+                    cy >>= BASEXPWR;
+                }
+                if (cy != 0)
+                {
+                    x->mant[cx++] = (MANTTYPE)cy;
+                }
+            }
+            x->cdigit = max(cx, 1);
+            return x;
+        }
+
+        // Split below the largest power that leaves some digits on top, then
+        // x = top * radix ** clow + bottom.
+        size_t level = 0;
+        while (((int64_t)cchunk << (level + 1)) < cd)
+        {
+            level++;
+        }
+        int32_t clow = cchunk << level;
+
+        PNUMBER x = radixtox(pd + clow, cd - clow, radix);
+        mulnumx(&x, radixpower(radix, level));
+        PNUMBER bottom = radixtox(pd, clow, radix);
+        addnum(&x, bottom, BASEX);
+        destroynum(bottom);
+        return x;
+    }
+
+    // Converts the non negative integer x into radix digits in pd[0..cd),
+    // which must be zeroed and long enough.
+    void xtoradix(PNUMBER x, MANTTYPE* pd, int32_t cd, uint32_t radix)
+    {
+        int32_t cx = x->cdigit + x->exp;
+
+        if (cx <= g_convDCThreshold || cx < 2)
+        {
+            // Divide the digits by the chunk power in place, each remainder is
+            // the next chunk of radix digits.
+            MANTTYPE chunkpower;
+            int32_t cchunk = chunkdigits(radix, &chunkpower);
+            vector<MANTTYPE> digits(cx);
+            memcpy(digits.data() + x->exp, x->mant, x->cdigit * sizeof(MANTTYPE));
+
+            for (int32_t id = 0; cx > 0;)
+            {
+                if (digits[cx - 1] == 0)
+                {
+                    cx--;
+                    continue;
+                }
+
+                TWO_MANTTYPE rem = 0;
+                for (int32_t i = cx - 1; i >= 0; i--)
+                {
+                    rem = (rem << BASEXPWR) | digits[i];
+                    digits[i] = (MANTTYPE)(rem / chunkpower);
+                    rem %= chunkpower;
+                }
+                for (int32_t i = 0; i < cchunk && id < cd; i++)
+                {
+                    pd[id++] = (MANTTYPE)(rem % radix);
+                    rem /= radix;
+                }
+            }
+            return;
+        }
+
+        // Split around a power with a quarter to a half of the digits of x,
+        // x = top * power + bottom with bottom < power.
+        size_t level = 0;
+        while (4 * radixpower(radix, level)->cdigit <= cx)
+        {
+            level++;
+        }
+        PNUMBER power = radixpower(radix, level);
+        MANTTYPE chunkpower;
+        int32_t clow = chunkdigits(radix, &chunkpower) << level;
+
+        // Long division gives exact quotient digits down to the units, cutting
+        // off the fraction leaves the integer quotient.
+        PNUMBER top = nullptr;
+        DUPNUM(top, x);
+        divnumx(&top, power, cx);
+        if (top->exp < 0)
+        {
+            int32_t cfrac = -top->exp;
+            if (cfrac >= top->cdigit)
+            {
+                top->cdigit = 1;
+                top->mant[0] = 0;
+            }
+            else
+            {
+                memmove(top->mant, top->mant + cfrac, (top->cdigit - cfrac) * sizeof(MANTTYPE));
+                top->cdigit -= cfrac;
+            }
+            top->exp = 0;
+        }
+
+        PNUMBER bottom = nullptr;
+        DUPNUM(bottom, top);
+        mulnumx(&bottom, power);
+        bottom->sign = -1;
+        addnum(&bottom, x, BASEX);
+
+        xtoradix(bottom, pd, clow, radix);
+        xtoradix(top, pd + clow, cd - clow, radix);
+        destroynum(bottom);
+        destroynum(top);
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 //    FUNCTION: nRadixxtonum
@@ -296,15 +818,19 @@ PRAT numtorat(_In_ PNUMBER pin, uint32_t radix)
 //
 //    DESCRIPTION: Does a base conversion on a number from
 //    internal to requested base. Assumes number being passed
-//    in is really in internal base form.
+//    in is really in internal base form.  The digits are
+//    split around powers of the radix down to numbers of
+//    g_convDCThreshold digits, which are divided into chunks
+//    of radix digits directly.
 //
 //----------------------------------------------------------------------------
 
 PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 
 {
-    PNUMBER sum = i32tonum(0, radix);
-    PNUMBER powofnRadix = i32tonum(BASEX, radix);
+    // BASEX itself doesn't fit in 32 bits, double half of it.
+    PNUMBER powofnRadix = Ui32tonum((uint32_t)(BASEX / 2), radix);
+    addnum(&powofnRadix, powofnRadix, radix);
 
     // A large penalty is paid for conversion of digits no one will see anyway.
     // limit the digits to the minimum of the existing precision or the
@@ -318,18 +844,33 @@ PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
     // scale by the internal base to the internal exponent offset of the LSD
     numpowi32(&powofnRadix, a->exp + (a->cdigit - cdigits), radix, precision);
 
-    // Loop over all the relative digits from MSD to LSD
-    for (MANTTYPE* ptr = &(a->mant[a->cdigit - 1]); cdigits > 0; ptr--, cdigits--)
+    // The relative digits from MSD down as an integer.
+    PNUMBER x = nullptr;
+    createnum(x, cdigits);
+    x->sign = 1;
+    x->cdigit = cdigits;
+    x->exp = 0;
+    memcpy(x->mant, a->mant + (a->cdigit - cdigits), cdigits * sizeof(MANTTYPE));
+
+    // Each BASEX digit makes at most BASEXPWR / floor(log2(radix)) radix
+    // digits.
+    int32_t cbits = 1;
+    while ((2u << cbits) <= radix)
     {
-        // Loop over all the bits from MSB to LSB
-        for (uint32_t bitmask = BASEX / 2; bitmask > 0; bitmask /= 2)
-        {
-            addnum(&sum, sum, radix);
-            if (*ptr & bitmask)
-            {
-                sum->mant[0] |= 1;
-            }
-        }
+        cbits++;
+    }
+    int32_t csum = (int32_t)(cdigits * BASEXPWR / cbits) + 1;
+
+    PNUMBER sum = nullptr;
+    createnum(sum, csum);
+    sum->sign = 1;
+    sum->cdigit = csum;
+    sum->exp = 0;
+    xtoradix(x, sum->mant, csum, radix);
+    destroynum(x);
+    while (sum->cdigit > 1 && sum->mant[sum->cdigit - 1] == 0)
+    {
+        sum->cdigit--;
     }
 
     // Scale answer by power of internal exponent.
@@ -350,30 +891,15 @@ PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 //
 //    DESCRIPTION: Does a radix conversion on a number from
 //    specified radix to requested radix.  Assumes the radix
-//    specified is the radix of the number passed in.
+//    specified is the radix of the number passed in.  Works
+//    the same way as nRadixxtonum, in reverse.
 //
 //-----------------------------------------------------------------------------
 
 PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix)
 {
-    PNUMBER pnumret = i32tonum(0, BASEX); // pnumret is the number in internal form.
+    PNUMBER pnumret = radixtox(a->mant, a->cdigit, radix); // pnumret is the number in internal form.
     PNUMBER num_radix = i32tonum(radix, BASEX);
-    MANTTYPE* ptrdigit = a->mant; // pointer to digit being worked on.
-
-    // Digits are in reverse order, back over them LSD first.
-    ptrdigit += a->cdigit - 1;
-
-    PNUMBER thisdigit = nullptr; // thisdigit holds the current digit of a
-    for (int32_t idigit = 0; idigit < a->cdigit; idigit++)
-    {
-        mulnumx(&pnumret, num_radix);
-        // WARNING:
-        // This should just smack in each digit into a 'special' thisdigit.
-        // and not do the overhead of recreating the number type each time.
-        thisdigit = i32tonum(*ptrdigit--, BASEX);
-        addnum(&pnumret, thisdigit, BASEX);
-        destroynum(thisdigit);
-    }
 
     // Calculate the exponent of the external base for scaling.
     numpowi32x(&num_radix, a->exp);
@@ -802,11 +1328,12 @@ PRAT Ui32torat(uint32_t inui32)
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER i32tonum(int32_t ini32, uint32_t radix)
+PNUMBER i32tonum(int32_t ini32, uint64_t radix)
 
 {
     MANTTYPE* pmant;
     PNUMBER pnumret = nullptr;
+    uint32_t ui32; // magnitude of ini32, which covers -2^31 as well
 
     createnum(pnumret, MAX_LONG_SIZE);
     pmant = pnumret->mant;
@@ -815,19 +1342,20 @@ PNUMBER i32tonum(int32_t ini32, uint32_t radix)
     if (ini32 < 0)
     {
         pnumret->sign = -1;
-        ini32 *= -1;
+        ui32 = 0 - (uint32_t)ini32;
     }
     else
     {
         pnumret->sign = 1;
+        ui32 = (uint32_t)ini32;
     }
 
     do
     {
-        *pmant++ = (MANTTYPE)(ini32 % radix);
-        ini32 /= radix;
+        *pmant++ = (MANTTYPE)(ui32 % radix);
+        ui32 = (uint32_t)(ui32 / radix);
         pnumret->cdigit++;
-    } while (ini32);
+    } while (ui32);
 
     return (pnumret);
 }
@@ -846,7 +1374,7 @@ PNUMBER i32tonum(int32_t ini32, uint32_t radix)
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
+PNUMBER Ui32tonum(uint32_t ini32, uint64_t radix)
 {
     MANTTYPE* pmant;
     PNUMBER pnumret = nullptr;
@@ -860,7 +1388,7 @@ PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
     do
     {
         *pmant++ = (MANTTYPE)(ini32 % radix);
-        ini32 /= radix;
+        ini32 = (uint32_t)(ini32 / radix);
         pnumret->cdigit++;
     } while (ini32);
 
@@ -988,9 +1516,9 @@ uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision)
 //    base   claimed.
 //
 //-----------------------------------------------------------------------------
-int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix)
+int32_t numtoi32(_In_ PNUMBER pnum, uint64_t radix)
 {
-    int32_t lret = 0;
+    uint32_t lret = 0; // Wraps around like a 32 bit register would.
 
     MANTTYPE* pmant = pnum->mant;
     pmant += pnum->cdigit - 1;
@@ -998,17 +1526,20 @@ int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix)
     int32_t expt = pnum->exp;
     for (int32_t length = pnum->cdigit; length > 0 && length + expt > 0; length--)
     {
-        lret *= radix;
+        lret = (uint32_t)(lret * radix);
         lret += *(pmant--);
     }
 
     while (expt-- > 0)
     {
-        lret *= radix;
+        lret = (uint32_t)(lret * radix);
+    }
+    if (pnum->sign < 0)
+    {
+        lret = 0 - lret;
     }
-    lret *= pnum->sign;
 
-    return lret;
+    return (int32_t)lret;
 }
 
 //-----------------------------------------------------------------------------
@@ -1327,6 +1858,69 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
     destroynum(pnum);
 }
 
+namespace
+{
+    // Sets r to a * u - b * v, which must not be negative.  u and v are
+    // integers in BASEX, r has room for a digit more than the longer of them.
+    void lincombnum(PNUMBER r, MANTTYPE a, PNUMBER u, MANTTYPE b, PNUMBER v)
+    {
+        int32_t cr = max(u->cdigit, v->cdigit) + 1;
+        TWO_MANTTYPE cya = 0;
+        TWO_MANTTYPE cyb = 0;
+        TWO_MANTTYPE borrow = 0;
+        for (int32_t i = 0; i < cr; i++)
+        {
+            if (i < u->cdigit)
+            {
+                cya += (TWO_MANTTYPE)a * u->mant[i];
+            }
+            if (i < v->cdigit)
+            {
+                cyb += (TWO_MANTTYPE)b * v->mant[i];
+            }
+
+            // A borrow wraps the difference round to the top bit.
+            TWO_MANTTYPE diff = (cya & (BASEX - 1)) - (cyb & (BASEX - 1)) - borrow;
+            r->mant[i] = (MANTTYPE)(diff & (BASEX - 1));
+            borrow = diff >> (2 * BASEXPWR - 1);
+            cya >>= BASEXPWR;
+            cyb >>= BASEXPWR;
+        }
+
+        while (cr > 1 && r->mant[cr - 1] == 0)
+        {
+            cr--;
+        }
+        r->cdigit = cr;
+    }
+
+    // The 62 bits of pnum in the place of the top 62 bits of a number cdigit
+    // digits long, whose top digit has clz leading zero bits.
+    int64_t topbits(PNUMBER pnum, int32_t cdigit, int32_t clz)
+    {
+        auto digit = [pnum](int32_t i) { return (i >= 0 && i < pnum->cdigit) ? (TWO_MANTTYPE)pnum->mant[i] : 0; };
+        TWO_MANTTYPE hi = (digit(cdigit - 1) << BASEXPWR) | digit(cdigit - 2);
+        if (clz > 0)
+        {
+            hi = (hi << clz) | (digit(cdigit - 3) >> (BASEXPWR - clz));
+        }
+        return (int64_t)(hi >> 2);
+    }
+
+    // A copy of the integer pnum with its exponent written out as digits, with
+    // room for cdigit digits.
+    PNUMBER integernum(PNUMBER pnum, int32_t cdigit)
+    {
+        PNUMBER pret = nullptr;
+        createnum(pret, cdigit);
+        pret->sign = 1;
+        pret->exp = 0;
+        pret->cdigit = pnum->cdigit + pnum->exp;
+        memcpy(pret->mant + pnum->exp, pnum->mant, pnum->cdigit * sizeof(MANTTYPE));
+        return pret;
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: gcd
@@ -1334,56 +1928,147 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
 //  ARGUMENTS:
 //              PNUMBER representation of a number.
 //              PNUMBER representation of a number.
-//              int for Radix
 //
 //  RETURN: Greatest common divisor in internal BASEX PNUMBER form.
 //
-//  DESCRIPTION: gcd uses remainders to find the greatest common divisor.
+//  DESCRIPTION: gcd uses Lehmer's algorithm to find the greatest
+//  common divisor.  The Euclidean steps are first worked out on the
+//  leading 62 bits of both numbers, for as long as the quotients are
+//  sure to match the full numbers', and then applied to the full
+//  numbers at once.  Only when the first quotient is already too big to
+//  know from the leading bits is there a full remainder to take.
 //
 //  ASSUMPTIONS: gcd assumes inputs are integers.
 //
-//  NOTE: Before it was found that the TRIM macro actually kept the
-//        size down cheaper than GCD, this routine was used extensively.
-//        now it is not used but might be later.
-//
 //-----------------------------------------------------------------------------
 
 PNUMBER gcd(_In_ PNUMBER a, _In_ PNUMBER b)
 {
-    PNUMBER r = nullptr;
-    PNUMBER larger = nullptr;
-    PNUMBER smaller = nullptr;
-
-    if (zernum(a))
-    {
-        return b;
-    }
-    else if (zernum(b))
+    // The numbers only get shorter, four of the longest length take all the
+    // steps.
+    int32_t cdigit = max(a->cdigit + a->exp, b->cdigit + b->exp) + 1;
+    PNUMBER u = integernum(a, cdigit);
+    PNUMBER v = integernum(b, cdigit);
+    PNUMBER unew = nullptr;
+    PNUMBER vnew = nullptr;
+    if (lessnum(u, v))
     {
-        return a;
+        swap(u, v);
     }
 
-    if (lessnum(a, b))
-    {
-        DUPNUM(larger, b);
-        DUPNUM(smaller, a);
-    }
-    else
+    while (v->cdigit > 1 && u->cdigit > 2)
     {
-        DUPNUM(larger, a);
-        DUPNUM(smaller, b);
+        if (unew == nullptr)
+        {
+            createnum(unew, cdigit);
+            createnum(vnew, cdigit);
+            unew->sign = 1;
+            vnew->sign = 1;
+        }
+
+        int32_t clz = 0;
+        for (MANTTYPE top = u->mant[u->cdigit - 1]; (top & (BASEX >> 1)) == 0; top <<= 1)
+        {
+            clz++;
+        }
+        int64_t uhat = topbits(u, u->cdigit, clz);
+        int64_t vhat = topbits(v, u->cdigit, clz);
+
+        // u' = A * u + B * v and v' = C * u + D * v, the signs of the
+        // cofactors alternate and they are kept within 31 bits.
+        int64_t A = 1;
+        int64_t B = 0;
+        int64_t C = 0;
+        int64_t D = 1;
+        while (vhat + C != 0 && vhat + D != 0)
+        {
+            int64_t q = (uhat + A) / (vhat + C);
+            if (q != (uhat + B) / (vhat + D) || q > INT32_MAX)
+            {
+                break;
+            }
+
+            int64_t T = A - q * C;
+            int64_t U = B - q * D;
+            if (T > INT32_MAX || T < -INT32_MAX || U > INT32_MAX || U < -INT32_MAX)
+            {
+                break;
+            }
+            A = C;
+            C = T;
+            B = D;
+            D = U;
+            T = uhat - q * vhat;
+            uhat = vhat;
+            vhat = T;
+        }
+
+        if (B == 0)
+        {
+            // The leading bits can't tell the quotient, take a full step.
+            PNUMBER r = nullptr;
+            DUPNUM(r, u);
+            remnum(&r, v, BASEX);
+            unew->cdigit = r->cdigit + r->exp;
+            memset(unew->mant, 0, r->exp * sizeof(MANTTYPE));
+            memcpy(unew->mant + r->exp, r->mant, r->cdigit * sizeof(MANTTYPE));
+            destroynum(r);
+            swap(u, v);
+            swap(v, unew);
+        }
+        else
+        {
+            if (B < 0)
+            {
+                lincombnum(unew, (MANTTYPE)A, u, (MANTTYPE)-B, v);
+                lincombnum(vnew, (MANTTYPE)D, v, (MANTTYPE)-C, u);
+            }
+            else
+            {
+                lincombnum(unew, (MANTTYPE)B, v, (MANTTYPE)-A, u);
+                lincombnum(vnew, (MANTTYPE)C, u, (MANTTYPE)-D, v);
+            }
+            swap(u, unew);
+            swap(v, vnew);
+        }
     }
 
-    while (!zernum(smaller))
+    // What is left fits in 64 bits, or v in one digit, finish in single
+    // precision.
+    if (!zernum(v))
     {
-        remnum(&larger, smaller, BASEX);
-        // swap larger and smaller
-        r = larger;
-        larger = smaller;
-        smaller = r;
+        TWO_MANTTYPE x;
+        TWO_MANTTYPE y;
+        if (u->cdigit <= 2)
+        {
+            x = u->mant[0] | (u->cdigit > 1 ? (TWO_MANTTYPE)u->mant[1] << BASEXPWR : 0);
+            y = v->mant[0] | (v->cdigit > 1 ? (TWO_MANTTYPE)v->mant[1] << BASEXPWR : 0);
+        }
+        else
+        {
+            TWO_MANTTYPE rem = 0;
+            x = v->mant[0];
+            for (int32_t i = u->cdigit - 1; i >= 0; i--)
+            {
+                rem = ((rem << BASEXPWR) | u->mant[i]) % x;
+            }
+            y = rem;
+        }
+
+        while (y != 0)
+        {
+            TWO_MANTTYPE r = x % y;
+            x = y;
+            y = r;
+        }
+        u->mant[0] = (MANTTYPE)(x & (BASEX - 1));
+        u->mant[1] = (MANTTYPE)(x >> BASEXPWR);
+        u->cdigit = (u->mant[1] != 0) ? 2 : 1;
     }
-    destroynum(smaller);
-    return larger;
+    destroynum(vnew);
+    destroynum(unew);
+    destroynum(v);
+    return u;
 }
 
 //-----------------------------------------------------------------------------
@@ -1466,7 +2151,7 @@ PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix)
 //
 //-----------------------------------------------------------------------------
 
-void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t precision)
+void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint64_t radix, int32_t precision)
 {
     PNUMBER lret = i32tonum(1, radix);
 
@@ -1488,46 +2173,117 @@ void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t pr
 //
 //    FUNCTION: ratpowi32
 //
-//    ARGUMENTS: root as rational, power as int32_t and precision as int32_t.
+//    ARGUMENTS: pointer to the result, root as rational, power as int32_t
+//    and precision as int32_t.
 //
-//    RETURN: None root is changed.
+//    RETURN: None, *pret is changed.
 //
-//    DESCRIPTION: changes rational representation of root to
-//    root ** power.
+//    DESCRIPTION: sets *pret to root ** power.  Works down the power with
+//    the same sliding window as numpowi32x, trimming after each multiply.
+//    root is only read, so it can be one of the constants.
 //
 //-----------------------------------------------------------------------------
 
-void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision)
+void ratpowi32(_Inout_ PRAT* pret, _In_ PRAT root, int32_t power, int32_t precision)
 
 {
     if (power < 0)
     {
         // Take the positive power and invert answer.
         PNUMBER pnumtemp = nullptr;
-        ratpowi32(proot, -power, precision);
-        pnumtemp = (*proot)->pp;
-        (*proot)->pp = (*proot)->pq;
-        (*proot)->pq = pnumtemp;
+        ratpowi32(pret, root, -power, precision);
+        pnumtemp = (*pret)->pp;
+        (*pret)->pp = (*pret)->pq;
+        (*pret)->pq = pnumtemp;
+    }
+    else if (power == 0)
+    {
+        DUPRAT(*pret, rat_one);
     }
     else
     {
-        PRAT lret = nullptr;
+        int32_t topbit = 0;
+        while ((power >> topbit) > 1)
+        {
+            topbit++;
+        }
+        int32_t cwindow = powwindow(topbit + 1);
 
-        lret = i32torat(1);
+        // root, root**3, root**5, ... root**(2**cwindow - 1)
+        vector<PRAT> odd((size_t)1 << (cwindow - 1));
+        odd[0] = root;
+        if (odd.size() > 1)
+        {
+            PRAT sqr = nullptr;
+            DUPRAT(sqr, root);
+            mulrat(&sqr, sqr, precision);
+            for (size_t i = 1; i < odd.size(); i++)
+            {
+                odd[i] = nullptr;
+                DUPRAT(odd[i], odd[i - 1]);
+                mulrat(&odd[i], sqr, precision);
+            }
+            destroyrat(sqr);
+        }
 
-        while (power > 0)
+        PRAT lret = nullptr;
+        for (int32_t bit = topbit; bit >= 0;)
         {
-            if (power & 1)
+            if (((power >> bit) & 1) == 0)
             {
-                mulnumx(&(lret->pp), (*proot)->pp);
-                mulnumx(&(lret->pq), (*proot)->pq);
+                mulrat(&lret, lret, precision);
+                bit--;
+                continue;
             }
-            mulrat(proot, *proot, precision);
-            trimit(&lret, precision);
-            trimit(proot, precision);
-            power >>= 1;
+
+            int32_t low = max(bit - cwindow + 1, 0);
+            while (((power >> low) & 1) == 0)
+            {
+                low++;
+            }
+            int32_t window = (power >> low) & ((1 << (bit - low + 1)) - 1);
+            if (lret == nullptr)
+            {
+                DUPRAT(lret, odd[window >> 1]);
+            }
+            else
+            {
+                for (int32_t i = low; i <= bit; i++)
+                {
+                    mulrat(&lret, lret, precision);
+                }
+                mulrat(&lret, odd[window >> 1], precision);
+            }
+            bit = low - 1;
         }
-        destroyrat(*proot);
-        *proot = lret;
+
+        for (size_t i = 1; i < odd.size(); i++)
+        {
+            destroyrat(odd[i]);
+        }
+        destroyrat(*pret);
+        *pret = lret;
     }
 }
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: ratpowi32
+//
+//    ARGUMENTS: root as rational, power as int32_t and precision as int32_t.
+//
+//    RETURN: None root is changed.
+//
+//    DESCRIPTION: changes rational representation of root to
+//    root ** power.
+//
+//-----------------------------------------------------------------------------
+
+void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision)
+
+{
+    PRAT lret = nullptr;
+    ratpowi32(&lret, *proot, power, precision);
+    destroyrat(*proot);
+    *proot = lret;
+}
@@ -147,8 +147,7 @@ void _gamma(PRAT* pn, uint32_t radix, int32_t precision)
 
         DUPRAT(tmp, *pn);
         addrat(&tmp, rat_one, precision);
-        destroyrat(term);
-        createrat(term);
+        // term becomes count + 1 in the numbers it already has.
         DUPNUM(term->pp, count);
         DUPNUM(term->pq, num_one);
         addrat(&term, rat_one, precision);
@@ -190,7 +189,6 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 {
     PRAT fact = nullptr;
     PRAT frac = nullptr;
-    PRAT neg_rat_one = nullptr;
 
     if (rat_gt(*px, rat_max_fact, precision) || rat_lt(*px, rat_min_fact, precision))
     {
@@ -200,9 +198,6 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 
     DUPRAT(fact, rat_one);
 
-    DUPRAT(neg_rat_one, rat_one);
-    neg_rat_one->pp->sign *= -1;
-
     DUPRAT(frac, *px);
     fracrat(&frac, radix, precision);
 
@@ -224,7 +219,7 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
         intrat(&fact, radix, precision);
     }
 
-    while (rat_lt(*px, neg_rat_one, precision))
+    while (rat_lt(*px, rat_neg_one, precision))
     {
         addrat(px, rat_one, precision);
         divrat(&fact, *px, precision);
@@ -243,5 +238,4 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 
     destroyrat(fact);
     destroyrat(frac);
-    destroyrat(neg_rat_one);
 }
@@ -17,6 +17,23 @@
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
 
+namespace
+{
+    // The next term of asin is thisterm * x^2 * (2j+1)^2 / ((2j+2)*(2j+3)).
+    void asinratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = (2 * (uint64_t)j + 1) * (2 * (uint64_t)j + 1);
+        *pden = (2 * (uint64_t)j + 2) * (2 * (uint64_t)j + 3);
+    }
+
+    // The next term of atan is thisterm * -x^2 * (2j+1) / (2j+3).
+    void atanratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 2 * (uint64_t)j + 1;
+        *pden = 2 * (uint64_t)j + 3;
+    }
+}
+
 void ascalerat(_Inout_ PRAT* pa, AngleType angletype, int32_t precision)
 {
     switch (angletype)
@@ -64,16 +81,12 @@ void ascalerat(_Inout_ PRAT* pa, AngleType angletype, int32_t precision)
 void _asinrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
-    DUPNUM(n2, num_one);
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
 
-    do
-    {
-        NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-    DESTROYTAYLOR();
+    sumseries(px, xx, asinratio, TAYLOR_ASIN, precision);
+    destroyrat(xx);
 }
 
 void asinanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t precision)
@@ -174,20 +187,13 @@ void acosanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
 void _acosrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
+    DUPRAT(*px, rat_one);
 
-    createrat(thisterm);
-    thisterm->pp = i32tonum(1L, BASEX);
-    thisterm->pq = i32tonum(1L, BASEX);
-
-    DUPNUM(n2, num_one);
-
-    do
-    {
-        NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-    DESTROYTAYLOR();
+    sumseries(px, xx, asinratio, TAYLOR_ACOS, precision);
+    destroyrat(xx);
 }
 
 void acosrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
@@ -259,21 +265,13 @@ void atananglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
 void _atanrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
-
-    DUPNUM(n2, num_one);
-
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
     xx->pp->sign *= -1;
 
-    do
-    {
-        NEXTTERM(xx, MULNUM(n2) INC(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-    DESTROYTAYLOR();
+    sumseries(px, xx, atanratio, TAYLOR_ATAN, precision);
+    destroyrat(xx);
 }
 
 void atanrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
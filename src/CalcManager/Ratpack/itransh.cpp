@@ -18,6 +18,16 @@
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
 
+namespace
+{
+    // The next term of asinh is thisterm * -x^2 * (2j+1)^2 / ((2j+2)*(2j+3)).
+    void asinhratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = (2 * (uint64_t)j + 1) * (2 * (uint64_t)j + 1);
+        *pden = (2 * (uint64_t)j + 2) * (2 * (uint64_t)j + 3);
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: asinhrat
@@ -67,20 +77,13 @@ void asinhrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
     }
     else
     {
-        CREATETAYLOR();
+        PRAT xx = nullptr;
+        DUPRAT(xx, *px);
+        mulrat(&xx, *px, precision);
         xx->pp->sign *= -1;
 
-        DUPRAT(pret, (*px));
-        DUPRAT(thisterm, (*px));
-
-        DUPNUM(n2, num_one);
-
-        do
-        {
-            NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-        } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-        DESTROYTAYLOR();
+        sumseries(px, xx, asinhratio, TAYLOR_ASINH, precision);
+        destroyrat(xx);
     }
     destroyrat(neg_pt_eight_five);
 }
@@ -32,8 +32,7 @@ void lshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision)
             throw(CALC_E_DOMAIN);
         }
         const int32_t intb = rattoi32(b, radix, precision);
-        DUPRAT(pwr, rat_two);
-        ratpowi32(&pwr, intb, precision);
+        ratpowi32(&pwr, rat_two, intb, precision);
         mulrat(pa, pwr, precision);
         destroyrat(pwr);
     }
@@ -54,8 +53,7 @@ void rshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision)
             throw(CALC_E_DOMAIN);
         }
         const int32_t intb = rattoi32(b, radix, precision);
-        DUPRAT(pwr, rat_two);
-        ratpowi32(&pwr, intb, precision);
+        ratpowi32(&pwr, rat_two, intb, precision);
         divrat(pa, pwr, precision);
         destroyrat(pwr);
     }
@@ -132,8 +130,6 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
 {
     PNUMBER c = nullptr;
     PNUMBER a = nullptr;
-    MANTTYPE* pcha;
-    MANTTYPE* pchb;
     MANTTYPE* pchc;
     int32_t cdigits;
     int32_t mexp;
@@ -142,17 +138,31 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
 
     a = *pa;
     cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
-    createnum(c, cdigits);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
+    mexp = min(a->exp, b->exp);
+
+    // Like _addnum, a is overwritten in place once lined up when it has room.
+    if (alignnum(a, mexp, cdigits))
+    {
+        c = a;
+    }
+    else
+    {
+        createnum(c, growcapacity(a->ccapacity, cdigits));
+    }
+    const MANTTYPE* pcha = a->mant;
+    const MANTTYPE* pchb = b->mant;
+    int32_t ashift = a->exp - mexp;
+    int32_t bshift = b->exp - mexp;
+    int32_t acdigit = a->cdigit;
+    int32_t bcdigit = b->cdigit;
+    c->sign = a->sign;
+    c->exp = mexp;
     c->cdigit = cdigits;
-    pcha = a->mant;
-    pchb = b->mant;
     pchc = c->mant;
-    for (; cdigits > 0; cdigits--, mexp++)
+    for (int32_t i = 0; i < cdigits; i++)
     {
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
+        da = ((i >= ashift) && (i - ashift < acdigit)) ? pcha[i - ashift] : 0;
+        db = ((i >= bshift) && (i - bshift < bcdigit)) ? pchb[i - bshift] : 0;
         switch (func)
         {
         case FUNC_AND:
@@ -166,13 +176,15 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
             break;
         }
     }
-    c->sign = a->sign;
     while (c->cdigit > 1 && *(--pchc) == 0)
     {
         c->cdigit--;
     }
-    destroynum(*pa);
-    *pa = c;
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -246,7 +258,8 @@ void modrat(_Inout_ PRAT* pa, _In_ PRAT b)
 
     if (needAdjust && !zerrat(*pa))
     {
-        addrat(pa, b, BASEX);
+        // Both are exact, don't let addrat trim the sum.
+        addrat(pa, b, INT32_MAX);
     }
 
     // Get *pa back in the integer over integer form.
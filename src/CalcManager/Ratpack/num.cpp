@@ -17,7 +17,7 @@
 //
 //
 //-----------------------------------------------------------------------------
-#include <list>
+#include <algorithm>
 #include <cstring> // for memmove
 #include "ratpak.h"
 
@@ -41,15 +41,16 @@ using namespace std;
 //
 //----------------------------------------------------------------------------
 
-void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix);
+void _addnum(PNUMBER* pa, PNUMBER b, uint64_t radix);
 
-void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 0)
     { // If b is zero we are done.
         if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 0)
         { // pa and b are both nonzero.
+            COUNTKERNEL(addnum, (*pa)->cdigit + b->cdigit);
             _addnum(pa, b, radix);
         }
         else
@@ -59,19 +60,17 @@ void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
     }
 }
 
-void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
+void _addnum(PNUMBER* pa, PNUMBER b, uint64_t radix)
 
 {
     PNUMBER c = nullptr; // c will contain the result.
     PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
-    MANTTYPE* pcha;      // pcha is a pointer to the mantissa of a.
-    MANTTYPE* pchb;      // pchb is a pointer to the mantissa of b.
     MANTTYPE* pchc;      // pchc is a pointer to the mantissa of c.
     int32_t cdigits;     // cdigits is the max count of the digits results used as a counter.
     int32_t mexp;        // mexp is the exponent of the result.
-    MANTTYPE da;         // da is a single 'digit' after possible padding.
-    MANTTYPE db;         // db is a single 'digit' after possible padding.
-    MANTTYPE cy = 0;     // cy is the value of a carry after adding two 'digits'
+    TWO_MANTTYPE da;     // da is a single 'digit' after possible padding.
+    TWO_MANTTYPE db;     // db is a single 'digit' after possible padding.
+    TWO_MANTTYPE cy = 0; // cy is the value of a carry after adding two 'digits'
     int32_t fcompla = 0; // fcompla is a flag to signal a is negative.
     int32_t fcomplb = 0; // fcomplb is a flag to signal b is negative.
 
@@ -80,14 +79,19 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     // Calculate the overlap of the numbers after alignment, this includes
     // necessary padding 0's
     cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
+    mexp = min(a->exp, b->exp);
 
-    createnum(c, cdigits + 1);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
-    c->cdigit = cdigits;
-    pcha = a->mant;
-    pchb = b->mant;
-    pchc = c->mant;
+    // When a has room for the sum, and a carry, it is lined up with the
+    // result and overwritten in place, a digit is always read before the
+    // same digit of the result is written.
+    if (alignnum(a, mexp, cdigits + 1))
+    {
+        c = a;
+    }
+    else
+    {
+        createnum(c, growcapacity(a->ccapacity, cdigits + 1));
+    }
 
     // Figure out the sign of the numbers
     if (a->sign != b->sign)
@@ -97,43 +101,55 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
         fcomplb = (b->sign == -1);
     }
 
+    const MANTTYPE* pcha = a->mant; // pcha is a pointer to the mantissa of a.
+    const MANTTYPE* pchb = b->mant; // pchb is a pointer to the mantissa of b.
+    int32_t ashift = a->exp - mexp; // padding 0's below a and b.
+    int32_t bshift = b->exp - mexp;
+    int32_t acdigit = a->cdigit;
+    int32_t bcdigit = b->cdigit;
+    int32_t asign = a->sign;
+
+    c->exp = mexp;
+    c->cdigit = cdigits;
+    pchc = c->mant;
+
     // Loop over all the digits, real and 0 padded. Here we know a and b are
     // aligned
-    for (; cdigits > 0; cdigits--, mexp++)
+    for (int32_t i = 0; i < cdigits; i++)
     {
         // Get digit from a, taking padding into account.
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
+        da = ((i >= ashift) && (i - ashift < acdigit)) ? pcha[i - ashift] : 0;
         // Get digit from b, taking padding into account.
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
+        db = ((i >= bshift) && (i - bshift < bcdigit)) ? pchb[i - bshift] : 0;
 
         // Handle complementing for a and b digit. Might be a better way, but
         // haven't found it yet.
         if (fcompla)
         {
-            da = (MANTTYPE)(radix)-1 - da;
+            da = radix - 1 - da;
         }
         if (fcomplb)
         {
-            db = (MANTTYPE)(radix)-1 - db;
+            db = radix - 1 - db;
         }
 
         // Update carry as necessary
         cy = da + db + cy;
-        *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-        cy /= (MANTTYPE)radix;
+        *pchc++ = (MANTTYPE)(cy % radix);
+        cy /= radix;
     }
 
     // Handle carry from last sum as extra digit
     if (cy && !(fcompla || fcomplb))
     {
-        *pchc++ = cy;
+        *pchc++ = (MANTTYPE)cy;
         c->cdigit++;
     }
 
     // Compute sign of result
     if (!(fcompla || fcomplb))
     {
-        c->sign = a->sign;
+        c->sign = asign;
     }
     else
     {
@@ -151,9 +167,9 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
             cy = 1;
             for ((cdigits = c->cdigit), (pchc = c->mant); cdigits > 0; cdigits--)
             {
-                cy = (MANTTYPE)radix - (MANTTYPE)1 - *pchc + cy;
-                *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-                cy /= (MANTTYPE)radix;
+                cy = radix - 1 - *pchc + cy;
+                *pchc++ = (MANTTYPE)(cy % radix);
+                cy /= radix;
             }
         }
     }
@@ -164,8 +180,11 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     {
         c->cdigit--;
     }
-    destroynum(*pa);
-    *pa = c;
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -183,9 +202,9 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //
 //----------------------------------------------------------------------------
 
-void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix);
+void _mulnum(PNUMBER* pa, PNUMBER b, uint64_t radix);
 
-void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
@@ -207,7 +226,7 @@ void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
     }
 }
 
-void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
+void _mulnum(PNUMBER* pa, PNUMBER b, uint64_t radix)
 
 {
     PNUMBER c = nullptr;  // c will contain the result.
@@ -260,14 +279,14 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
             while (mcy || cy)
             {
                 // update carry from addition(s) and multiply.
-                cy += (TWO_MANTTYPE)pchc[icdigit] + (mcy % (TWO_MANTTYPE)radix);
+                cy += (TWO_MANTTYPE)pchc[icdigit] + (mcy % radix);
 
                 // update result digit from
-                pchc[icdigit++] = (MANTTYPE)(cy % (TWO_MANTTYPE)radix);
+                pchc[icdigit++] = (MANTTYPE)(cy % radix);
 
                 // update carries from
-                mcy /= (TWO_MANTTYPE)radix;
-                cy /= (TWO_MANTTYPE)radix;
+                mcy /= radix;
+                cy /= radix;
             }
 
             pchb++;
@@ -286,6 +305,175 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     *pa = c;
 }
 
+namespace
+{
+    // Digit arithmetic in BASEX, the divisions by the radix are shifts.
+    struct BaseXDigits
+    {
+        static constexpr TWO_MANTTYPE radix = BASEX;
+    };
+
+    // Digit arithmetic in any other radix.
+    struct RadixDigits
+    {
+        TWO_MANTTYPE radix;
+    };
+
+    // p[0..c) *= d, returns the digit carried out of the top.
+    template <class Digits>
+    MANTTYPE mulmantsmall(MANTTYPE* p, int32_t c, MANTTYPE d, Digits digits)
+    {
+        TWO_MANTTYPE carry = 0;
+        for (int32_t i = 0; i < c; i++)
+        {
+            TWO_MANTTYPE t = (TWO_MANTTYPE)p[i] * d + carry;
+            p[i] = (MANTTYPE)(t % digits.radix);
+            carry = t / digits.radix;
+        }
+        return (MANTTYPE)carry;
+    }
+
+    // Long division of pu[0..cu) by pv[0..cv), one digit at a time, guessing
+    // each digit from the leading digits (Knuth's algorithm D).  pu[cu] must
+    // be zero, pv is scratch and gets normalized in place.  The cu - cv + 1
+    // quotient digits go in pq when it is not null, the remainder is left in
+    // pu[0..cv) and pu[cv..cu] ends up zero.  pu[0..czero) is known to be
+    // zero so the division stops there once nothing is left to divide.
+    template <class Digits>
+    void divremmant(MANTTYPE* pq, MANTTYPE* pu, int32_t cu, MANTTYPE* pv, int32_t cv, int32_t czero, Digits digits)
+    {
+        const TWO_MANTTYPE radix = digits.radix;
+
+        if (cv == 1)
+        {
+            TWO_MANTTYPE v = pv[0];
+            TWO_MANTTYPE rem = 0;
+            for (int32_t j = cu - 1; j >= 0; j--)
+            {
+                if (rem == 0 && j < czero)
+                {
+                    if (pq != nullptr)
+                    {
+                        memset(pq, 0, (j + 1) * sizeof(MANTTYPE));
+                    }
+                    break;
+                }
+                rem = rem * radix + pu[j];
+                pu[j] = 0;
+                if (pq != nullptr)
+                {
+                    pq[j] = (MANTTYPE)(rem / v);
+                }
+                rem %= v;
+            }
+            pu[0] = (MANTTYPE)rem;
+            return;
+        }
+
+        // Scale both so the top digit of the divisor is at least radix / 2,
+        // this keeps the digit guesses at most two too large.
+        MANTTYPE d = (MANTTYPE)(radix / ((TWO_MANTTYPE)pv[cv - 1] + 1));
+        if (d > 1)
+        {
+            mulmantsmall(pv, cv, d, digits);
+            pu[cu] = mulmantsmall(pu, cu, d, digits);
+        }
+
+        TWO_MANTTYPE vtop = pv[cv - 1];
+        TWO_MANTTYPE vnext = pv[cv - 2];
+        for (int32_t j = cu - cv; j >= 0; j--)
+        {
+            TWO_MANTTYPE num = pu[j + cv] * radix + pu[j + cv - 1];
+            TWO_MANTTYPE qhat = num / vtop;
+            TWO_MANTTYPE rhat = num % vtop;
+            while (qhat >= radix || qhat * vnext > rhat * radix + pu[j + cv - 2])
+            {
+                qhat--;
+                rhat += vtop;
+                if (rhat >= radix)
+                {
+                    break;
+                }
+            }
+
+            // pu[j..j+cv] -= qhat * pv
+            TWO_MANTTYPE carry = 0;
+            int64_t borrow = 0;
+            int64_t t;
+            for (int32_t i = 0; i < cv; i++)
+            {
+                TWO_MANTTYPE p = qhat * pv[i] + carry;
+                carry = p / radix;
+                t = (int64_t)pu[i + j] - (int64_t)(p % radix) - borrow;
+                borrow = t < 0;
+                pu[i + j] = (MANTTYPE)(borrow ? t + (int64_t)radix : t);
+            }
+            t = (int64_t)pu[j + cv] - (int64_t)carry - borrow;
+
+            if (t < 0)
+            {
+                // Rarely the guess is still one too big, add pv back.
+                qhat--;
+                carry = 0;
+                for (int32_t i = 0; i < cv; i++)
+                {
+                    TWO_MANTTYPE s = (TWO_MANTTYPE)pu[i + j] + pv[i] + carry;
+                    pu[i + j] = (MANTTYPE)(s % radix);
+                    carry = s / radix;
+                }
+                t += (int64_t)carry;
+            }
+            pu[j + cv] = (MANTTYPE)t;
+            if (pq != nullptr)
+            {
+                pq[j] = (MANTTYPE)qhat;
+            }
+
+            if (j <= czero && pu[j + cv - 1] == 0)
+            {
+                int32_t i = j + cv - 1;
+                while (i > j && pu[i - 1] == 0)
+                {
+                    i--;
+                }
+                if (i == j)
+                {
+                    // Nothing left to divide, the remaining digits are zero.
+                    if (pq != nullptr)
+                    {
+                        memset(pq, 0, j * sizeof(MANTTYPE));
+                    }
+                    return;
+                }
+            }
+        }
+
+        if (d > 1)
+        {
+            // Scale the remainder back down.
+            TWO_MANTTYPE rem = 0;
+            for (int32_t i = cv - 1; i >= 0; i--)
+            {
+                rem = rem * radix + pu[i];
+                pu[i] = (MANTTYPE)(rem / d);
+                rem %= d;
+            }
+        }
+    }
+
+    void divremmant(MANTTYPE* pq, MANTTYPE* pu, int32_t cu, MANTTYPE* pv, int32_t cv, int32_t czero, uint64_t radix)
+    {
+        if (radix == BASEX)
+        {
+            divremmant(pq, pu, cu, pv, cv, czero, BaseXDigits{});
+        }
+        else
+        {
+            divremmant(pq, pu, cu, pv, cv, czero, RadixDigits{ radix });
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 //    FUNCTION: remnum
@@ -296,56 +484,55 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa %= b.
-//            Repeatedly subtracts off powers of 2 of b until *pa < b.
+//            Lines both numbers up on the smaller exponent and does the
+//            long division in place, in the memory of the answer.
 //
 //
 //----------------------------------------------------------------------------
 
-void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
-    PNUMBER tmp = nullptr;     // tmp is the working remainder.
-    PNUMBER lasttmp = nullptr; // lasttmp is the last remainder which worked.
+    PNUMBER a = *pa;
 
-    // Once *pa is less than b, *pa is the remainder.
-    while (!lessnum(*pa, b))
+    // If *pa is less than b, *pa is the remainder.
+    if (lessnum(a, b))
     {
-        DUPNUM(tmp, b);
-        if (lessnum(tmp, *pa))
-        {
-            // Start off close to the right answer for subtraction.
-            tmp->exp = (*pa)->cdigit + (*pa)->exp - tmp->cdigit;
-            if (MSD(*pa) <= MSD(tmp))
-            {
-                // Don't take the chance that the numbers are equal.
-                tmp->exp--;
-            }
-        }
-
-        destroynum(lasttmp);
-        lasttmp = i32tonum(0, radix);
+        return;
+    }
 
-        while (lessnum(tmp, *pa))
-        {
-            DUPNUM(lasttmp, tmp);
-            addnum(&tmp, tmp, radix);
-        }
+    // Digits of b's exponent below a's pass straight through to the
+    // remainder, the rest of a is divided by b's mantissa.
+    int32_t exp = min(a->exp, b->exp);
+    int32_t cu = a->cdigit + a->exp - exp;
+    int32_t clow = b->exp - exp;
 
-        if (lessnum(*pa, tmp))
-        {
-            // too far, back up...
-            destroynum(tmp);
-            tmp = lasttmp;
-            lasttmp = nullptr;
-        }
+    // The answer holds the remainder, with room for the divisor's scratch
+    // copy above it.
+    PNUMBER c = nullptr;
+    createnum(c, cu + 1 + b->cdigit);
+    MANTTYPE* pu = c->mant;
+    MANTTYPE* pv = pu + cu + 1;
+    memcpy(pu + a->exp - exp, a->mant, a->cdigit * sizeof(MANTTYPE));
+    memcpy(pv, b->mant, b->cdigit * sizeof(MANTTYPE));
 
-        // Subtract the working remainder from the remainder holder.
-        tmp->sign = -1 * (*pa)->sign;
-        addnum(pa, tmp, radix);
+    divremmant(nullptr, pu + clow, cu - clow, pv, b->cdigit, 0, radix);
 
-        destroynum(tmp);
-        destroynum(lasttmp);
+    c->cdigit = clow + b->cdigit;
+    c->exp = exp;
+    c->sign = a->sign;
+    while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+    {
+        c->cdigit--;
     }
+    if (zernum(c))
+    {
+        c->sign = 1;
+        c->exp = 0;
+    }
+
+    destroynum(*pa);
+    *pa = c;
 }
 
 //---------------------------------------------------------------------------
@@ -362,9 +549,9 @@ void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
 //
 //---------------------------------------------------------------------------
 
-void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision);
+void _divnum(PNUMBER* pa, PNUMBER b, uint64_t radix, int32_t precision);
 
-void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precision)
+void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t precision)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
@@ -378,7 +565,7 @@ void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precisi
     }
 }
 
-void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
+void _divnum(PNUMBER* pa, PNUMBER b, uint64_t radix, int32_t precision)
 {
     PNUMBER a = *pa;
     int32_t thismax = precision + 2;
@@ -392,69 +579,41 @@ void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
         thismax = b->cdigit;
     }
 
+    // Line the top of a up with the top of b and shift in enough zeros for
+    // thismax quotient digits.  The answer holds the quotient with room for
+    // the scratch copies of a and b above it.
+    int32_t cshift = b->cdigit - a->cdigit + thismax - 1;
+    int32_t cu = a->cdigit + cshift;
+
     PNUMBER c = nullptr;
-    createnum(c, thismax + 1);
+    createnum(c, thismax + 1 + cu + 1 + b->cdigit);
     c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
     c->sign = a->sign * b->sign;
 
-    MANTTYPE* ptrc = c->mant + thismax;
-    PNUMBER rem = nullptr;
-    PNUMBER tmp = nullptr;
-    DUPNUM(rem, a);
-    DUPNUM(tmp, b);
-    tmp->sign = a->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
+    MANTTYPE* pu = c->mant + thismax + 1;
+    MANTTYPE* pv = pu + cu + 1;
+    memcpy(pu + cshift, a->mant, a->cdigit * sizeof(MANTTYPE));
+    memcpy(pv, b->mant, b->cdigit * sizeof(MANTTYPE));
 
-    // Build a table of multiplications of the divisor, this is quicker for
-    // more than radix 'digits'
-    list<PNUMBER> numberList{ i32tonum(0L, radix) };
-    for (uint32_t i = 1; i < radix; i++)
-    {
-        PNUMBER newValue = nullptr;
-        DUPNUM(newValue, numberList.front());
-        addnum(&newValue, tmp, radix);
+    divremmant(c->mant, pu, cu, pv, b->cdigit, cshift, radix);
 
-        numberList.emplace_front(newValue);
-    }
-    destroynum(tmp);
-
-    int32_t digit;
-    int32_t cdigits = 0;
-    while (cdigits++ < thismax && !zernum(rem))
+    // The long hand division stops at the last nonzero digit.
+    int32_t cdigits = thismax;
+    MANTTYPE* ptrc = c->mant;
+    bool exact = all_of(pu, pu + b->cdigit, [](MANTTYPE digit) { return digit == 0; });
+    if (exact)
     {
-        digit = radix - 1;
-        PNUMBER multiple = nullptr;
-        for (const auto& num : numberList)
-        {
-            if (!lessnum(rem, num) || !--digit)
-            {
-                multiple = num;
-                break;
-            }
-        }
-
-        if (digit)
+        while (cdigits > 0 && *ptrc == 0)
         {
-            multiple->sign *= -1;
-            addnum(&rem, multiple, radix);
-            multiple->sign *= -1;
+            ptrc++;
+            cdigits--;
         }
-        rem->exp++;
-        *ptrc-- = (MANTTYPE)digit;
     }
-    cdigits--;
-
-    if (c->mant != ++ptrc)
+    if (c->mant != ptrc)
     {
         memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
     }
 
-    // Cleanup table structure
-    for (auto& num : numberList)
-    {
-        destroynum(num);
-    }
-
     if (!cdigits)
     {
         c->cdigit = 1;
@@ -469,7 +628,6 @@ void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
             c->cdigit--;
         }
     }
-    destroynum(rem);
 
     destroynum(*pa);
     *pa = c;
@@ -577,10 +735,9 @@ bool lessnum(_In_ PNUMBER a, _In_ PNUMBER b)
     {
         MANTTYPE da = ((cdigits > (ccdigits - a->cdigit)) ? *pa-- : 0);
         MANTTYPE db = ((cdigits > (ccdigits - b->cdigit)) ? *pb-- : 0);
-        diff = da - db;
-        if (diff)
+        if (da != db)
         {
-            return (diff < 0);
+            return (da < db);
         }
     }
     // In this case, they are equal.
@@ -7,6 +7,7 @@
 inline const NUMBER init_num_one = { 1,
                                      1,
                                      0,
+                                     1,
                                      {
                                          1,
                                      } };
@@ -14,6 +15,7 @@ inline const NUMBER init_num_one = { 1,
 inline const NUMBER init_num_two = { 1,
                                      1,
                                      0,
+                                     1,
                                      {
                                          2,
                                      } };
@@ -21,6 +23,7 @@ inline const NUMBER init_num_two = { 1,
 inline const NUMBER init_num_five = { 1,
                                       1,
                                       0,
+                                      1,
                                       {
                                           5,
                                       } };
@@ -28,6 +31,7 @@ inline const NUMBER init_num_five = { 1,
 inline const NUMBER init_num_six = { 1,
                                      1,
                                      0,
+                                     1,
                                      {
                                          6,
                                      } };
@@ -35,6 +39,7 @@ inline const NUMBER init_num_six = { 1,
 inline const NUMBER init_num_ten = { 1,
                                      1,
                                      0,
+                                     1,
                                      {
                                          10,
                                      } };
@@ -42,44 +47,50 @@ inline const NUMBER init_num_ten = { 1,
 inline const NUMBER init_p_rat_smallest = { 1,
                                             1,
                                             0,
+                                            1,
                                             {
                                                 1,
                                             } };
 inline const NUMBER init_q_rat_smallest = { 1,
                                             4,
                                             0,
+                                            4,
                                             {
                                                 0,
-                                                190439170,
-                                                901055854,
-                                                10097,
+                                                2242703233,
+                                                762134875,
+                                                1262,
                                             } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rat_negsmallest = { -1,
                                                1,
                                                0,
+                                               1,
                                                {
                                                    1,
                                                } };
 inline const NUMBER init_q_rat_negsmallest = { 1,
                                                4,
                                                0,
+                                               4,
                                                {
                                                    0,
-                                                   190439170,
-                                                   901055854,
-                                                   10097,
+                                                   2242703233,
+                                                   762134875,
+                                                   1262,
                                                } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_pt_eight_five = { 1,
                                              1,
                                              0,
+                                             1,
                                              {
                                                  85,
                                              } };
 inline const NUMBER init_q_pt_eight_five = { 1,
                                              1,
                                              0,
+                                             1,
                                              {
                                                  100,
                                              } };
@@ -87,12 +98,14 @@ inline const NUMBER init_q_pt_eight_five = { 1,
 inline const NUMBER init_p_rat_six = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            6,
                                        } };
 inline const NUMBER init_q_rat_six = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -100,12 +113,14 @@ inline const NUMBER init_q_rat_six = { 1,
 inline const NUMBER init_p_rat_two = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            2,
                                        } };
 inline const NUMBER init_q_rat_two = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -113,12 +128,14 @@ inline const NUMBER init_q_rat_two = { 1,
 inline const NUMBER init_p_rat_zero = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             0,
                                         } };
 inline const NUMBER init_q_rat_zero = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             1,
                                         } };
@@ -126,12 +143,14 @@ inline const NUMBER init_q_rat_zero = { 1,
 inline const NUMBER init_p_rat_one = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
 inline const NUMBER init_q_rat_one = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -139,12 +158,14 @@ inline const NUMBER init_q_rat_one = { 1,
 inline const NUMBER init_p_rat_neg_one = { -1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
 inline const NUMBER init_q_rat_neg_one = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
@@ -152,12 +173,14 @@ inline const NUMBER init_q_rat_neg_one = { 1,
 inline const NUMBER init_p_rat_half = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             1,
                                         } };
 inline const NUMBER init_q_rat_half = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             2,
                                         } };
@@ -165,12 +188,14 @@ inline const NUMBER init_q_rat_half = { 1,
 inline const NUMBER init_p_rat_ten = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            10,
                                        } };
 inline const NUMBER init_q_rat_ten = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -178,258 +203,280 @@ inline const NUMBER init_q_rat_ten = { 1,
 inline const NUMBER init_p_pi = { 1,
                                   6,
                                   0,
+                                  6,
                                   {
-                                      125527896,
-                                      283898350,
-                                      1960493936,
-                                      1672850762,
-                                      1288168272,
-                                      8,
+                                      836823330,
+                                      2228005484,
+                                      2007728014,
+                                      3641439035,
+                                      1492181193,
+                                      577,
                                   } };
 inline const NUMBER init_q_pi = { 1,
                                   6,
                                   0,
+                                  6,
                                   {
-                                      1288380402,
-                                      1120116153,
-                                      1860424692,
-                                      1944118326,
-                                      1583591604,
-                                      2,
+                                      1445622284,
+                                      2839935290,
+                                      1025226936,
+                                      778905190,
+                                      3330288873,
+                                      183,
                                   } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_two_pi = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          251055792,
-                                          567796700,
-                                          1773504224,
-                                          1198217877,
-                                          428852897,
-                                          17,
+                                          1673646660,
+                                          161043672,
+                                          4015456029,
+                                          2987910774,
+                                          2984362387,
+                                          1154,
                                       } };
 inline const NUMBER init_q_two_pi = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          1288380402,
-                                          1120116153,
-                                          1860424692,
-                                          1944118326,
-                                          1583591604,
-                                          2,
+                                          1445622284,
+                                          2839935290,
+                                          1025226936,
+                                          778905190,
+                                          3330288873,
+                                          183,
                                       } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_pi_over_two = { 1,
                                            6,
                                            0,
+                                           6,
                                            {
-                                               125527896,
-                                               283898350,
-                                               1960493936,
-                                               1672850762,
-                                               1288168272,
-                                               8,
+                                               836823330,
+                                               2228005484,
+                                               2007728014,
+                                               3641439035,
+                                               1492181193,
+                                               577,
                                            } };
 inline const NUMBER init_q_pi_over_two = { 1,
                                            6,
                                            0,
+                                           6,
                                            {
-                                               429277156,
-                                               92748659,
-                                               1573365737,
-                                               1740753005,
-                                               1019699561,
-                                               5,
+                                               2891244568,
+                                               1384903284,
+                                               2050453873,
+                                               1557810380,
+                                               2365610450,
+                                               367,
                                            } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_one_pt_five_pi = { 1,
                                               6,
                                               0,
+                                              6,
                                               {
-                                                  1241201312,
-                                                  270061909,
-                                                  1051574664,
-                                                  1924965045,
-                                                  1340320627,
-                                                  70,
+                                                  94234592,
+                                                  1553938009,
+                                                  1001531981,
+                                                  688916499,
+                                                  3223732040,
+                                                  318306,
                                               } };
 inline const NUMBER init_q_one_pt_five_pi = { 1,
                                               6,
                                               0,
+                                              6,
                                               {
-                                                  1579671539,
-                                                  1837970263,
-                                                  1067644340,
-                                                  523549916,
-                                                  2119366659,
-                                                  14,
+                                                  4192749270,
+                                                  915678306,
+                                                  4117303767,
+                                                  165301797,
+                                                  3394598412,
+                                                  67546,
                                               } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_e_to_one_half = { 1,
                                              6,
                                              0,
+                                             6,
                                              {
-                                                 256945612,
-                                                 216219427,
-                                                 223516738,
-                                                 477442596,
-                                                 581063757,
-                                                 23,
+                                                 3834506173,
+                                                 2817957564,
+                                                 170242942,
+                                                 2727859231,
+                                                 511069765,
+                                                 2789862599,
                                              } };
 inline const NUMBER init_q_e_to_one_half = { 1,
                                              6,
                                              0,
+                                             6,
                                              {
-                                                 1536828363,
-                                                 698484484,
-                                                 1127331835,
-                                                 224219346,
-                                                 245499408,
-                                                 14,
+                                                 158701381,
+                                                 1262119108,
+                                                 3151027270,
+                                                 2088428409,
+                                                 3226571841,
+                                                 1692137202,
                                              } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rat_exp = { 1,
                                        6,
                                        0,
+                                       6,
                                        {
-                                           943665199,
-                                           1606559160,
-                                           1094967530,
-                                           1759391384,
-                                           1671799163,
-                                           1123581,
+                                           3781495621,
+                                           2284788351,
+                                           1356671647,
+                                           1307760160,
+                                           3011344574,
+                                           38,
                                        } };
 inline const NUMBER init_q_rat_exp = { 1,
                                        6,
                                        0,
+                                       6,
                                        {
-                                           879242208,
-                                           2022880100,
-                                           617392930,
-                                           1374929092,
-                                           1367479163,
-                                           413342,
+                                           3498680955,
+                                           416374151,
+                                           1126449324,
+                                           3649073059,
+                                           1019416025,
+                                           14,
                                        } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_ln_ten = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          2086268922,
-                                          165794492,
-                                          1416063951,
-                                          1851428830,
-                                          1893239400,
-                                          65366841,
+                                          2807688168,
+                                          3851951690,
+                                          2632185143,
+                                          3467311596,
+                                          2670219632,
+                                          411,
                                       } };
 inline const NUMBER init_q_ln_ten = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          26790652,
-                                          564532679,
-                                          783998273,
-                                          216030448,
-                                          1564709968,
-                                          28388458,
+                                          3515100962,
+                                          3358307806,
+                                          1951946227,
+                                          3329223464,
+                                          3285808169,
+                                          178,
                                       } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_ln_two = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          1789230241,
-                                          1057927868,
-                                          715399197,
-                                          908801241,
-                                          1411265331,
-                                          3,
+                                          1642081285,
+                                          1887455694,
+                                          1599965787,
+                                          64092753,
+                                          2704104999,
+                                          132962,
                                       } };
 inline const NUMBER init_q_ln_two = { 1,
                                       6,
                                       0,
+                                      6,
                                       {
-                                          1559869847,
-                                          1930657510,
-                                          1228561531,
-                                          219003871,
-                                          593099283,
-                                          5,
+                                          1896676670,
+                                          1474045669,
+                                          697947952,
+                                          3013697077,
+                                          2260635947,
+                                          191824,
                                       } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rad_to_deg = { 1,
                                           6,
                                           0,
+                                          6,
                                           {
-                                              2127722024,
-                                              1904928383,
-                                              2016479213,
-                                              2048947859,
-                                              1578647346,
-                                              492,
+                                              2513973360,
+                                              87244036,
+                                              4152222167,
+                                              2763980770,
+                                              2451543028,
+                                              33079,
                                           } };
 inline const NUMBER init_q_rad_to_deg = { 1,
                                           6,
                                           0,
+                                          6,
                                           {
-                                              125527896,
-                                              283898350,
-                                              1960493936,
-                                              1672850762,
-                                              1288168272,
-                                              8,
+                                              836823330,
+                                              2228005484,
+                                              2007728014,
+                                              3641439035,
+                                              1492181193,
+                                              577,
                                           } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rad_to_grad = { 1,
                                            6,
                                            0,
+                                           6,
                                            {
-                                               2125526288,
-                                               684931327,
-                                               570267400,
-                                               129125085,
-                                               1038224725,
-                                               547,
+                                               1361647968,
+                                               1051374995,
+                                               3181924420,
+                                               1162215391,
+                                               337843756,
+                                               36755,
                                            } };
 inline const NUMBER init_q_rad_to_grad = { 1,
                                            6,
                                            0,
+                                           6,
                                            {
-                                               125527896,
-                                               283898350,
-                                               1960493936,
-                                               1672850762,
-                                               1288168272,
-                                               8,
+                                               836823330,
+                                               2228005484,
+                                               2007728014,
+                                               3641439035,
+                                               1492181193,
+                                               577,
                                            } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rat_qword = { 1,
-                                         3,
+                                         2,
                                          0,
+                                         2,
                                          {
-                                             2147483647,
-                                             2147483647,
-                                             3,
+                                             4294967295,
+                                             4294967295,
                                          } };
 inline const NUMBER init_q_rat_qword = { 1,
                                          1,
                                          0,
+                                         1,
                                          {
                                              1,
                                          } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rat_dword = { 1,
-                                         2,
+                                         1,
                                          0,
+                                         1,
                                          {
-                                             2147483647,
-                                             1,
+                                             4294967295,
                                          } };
 inline const NUMBER init_q_rat_dword = { 1,
                                          1,
                                          0,
+                                         1,
                                          {
                                              1,
                                          } };
@@ -437,26 +484,29 @@ inline const NUMBER init_q_rat_dword = { 1,
 inline const NUMBER init_p_rat_max_i32 = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                2147483647,
                                            } };
 inline const NUMBER init_q_rat_max_i32 = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
 // Autogenerated by _dumprawrat in support.cpp
 inline const NUMBER init_p_rat_min_i32 = { -1,
-                                           2,
+                                           1,
                                            0,
+                                           1,
                                            {
-                                               0,
-                                               1,
+                                               2147483648,
                                            } };
 inline const NUMBER init_q_rat_min_i32 = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
@@ -464,12 +514,14 @@ inline const NUMBER init_q_rat_min_i32 = { 1,
 inline const NUMBER init_p_rat_word = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             65535,
                                         } };
 inline const NUMBER init_q_rat_word = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             1,
                                         } };
@@ -477,12 +529,14 @@ inline const NUMBER init_q_rat_word = { 1,
 inline const NUMBER init_p_rat_byte = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             255,
                                         } };
 inline const NUMBER init_q_rat_byte = { 1,
                                         1,
                                         0,
+                                        1,
                                         {
                                             1,
                                         } };
@@ -490,12 +544,14 @@ inline const NUMBER init_q_rat_byte = { 1,
 inline const NUMBER init_p_rat_400 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            400,
                                        } };
 inline const NUMBER init_q_rat_400 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -503,12 +559,14 @@ inline const NUMBER init_q_rat_400 = { 1,
 inline const NUMBER init_p_rat_360 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            360,
                                        } };
 inline const NUMBER init_q_rat_360 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -516,12 +574,14 @@ inline const NUMBER init_q_rat_360 = { 1,
 inline const NUMBER init_p_rat_200 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            200,
                                        } };
 inline const NUMBER init_q_rat_200 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -529,12 +589,14 @@ inline const NUMBER init_q_rat_200 = { 1,
 inline const NUMBER init_p_rat_180 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            180,
                                        } };
 inline const NUMBER init_q_rat_180 = { 1,
                                        1,
                                        0,
+                                       1,
                                        {
                                            1,
                                        } };
@@ -542,12 +604,14 @@ inline const NUMBER init_q_rat_180 = { 1,
 inline const NUMBER init_p_rat_max_exp = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                100000,
                                            } };
 inline const NUMBER init_q_rat_max_exp = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
@@ -555,12 +619,14 @@ inline const NUMBER init_q_rat_max_exp = { 1,
 inline const NUMBER init_p_rat_min_exp = { -1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                100000,
                                            } };
 inline const NUMBER init_q_rat_min_exp = { 1,
                                            1,
                                            0,
+                                           1,
                                            {
                                                1,
                                            } };
@@ -569,12 +635,14 @@ inline const NUMBER init_q_rat_min_exp = { 1,
 inline const NUMBER init_p_rat_max_fact = { 1,
                                             1,
                                             0,
+                                            1,
                                             {
                                                 3249,
                                             } };
 inline const NUMBER init_q_rat_max_fact = { 1,
                                             1,
                                             0,
+                                            1,
                                             {
                                                 1,
                                             } };
@@ -583,12 +651,14 @@ inline const NUMBER init_q_rat_max_fact = { 1,
 inline const NUMBER init_p_rat_min_fact = { -1,
                                             1,
                                             0,
+                                            1,
                                             {
                                                 1000,
                                             } };
 inline const NUMBER init_q_rat_min_fact = { 1,
                                             1,
                                             0,
+                                            1,
                                             {
                                                 1,
                                             } };
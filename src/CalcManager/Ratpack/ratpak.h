@@ -23,10 +23,10 @@
 #include <cstring>              // for memmove
 #include "sal_cross_platform.h" // for SAL
 
-static constexpr uint32_t BASEXPWR = 31L;     // Internal log2(BASEX)
-static constexpr uint32_t BASEX = 0x80000000; // Internal radix used in calculations, hope to raise
-                                              // this to 2^32 after solving scaling problems with
-                                              // overflow detection esp. in mul
+static constexpr uint32_t BASEXPWR = 32L;      // Internal log2(BASEX)
+static constexpr uint64_t BASEX = 0x100000000; // Internal radix used in calculations, a whole
+                                               // MANTTYPE per digit.  Radixes that can be BASEX
+                                               // are passed as uint64_t.
 
 typedef uint32_t MANTTYPE;
 typedef uint64_t TWO_MANTTYPE;
@@ -55,11 +55,13 @@ enum class AngleType
 #pragma warning(disable : 4200) // nonstandard extension used : zero-sized array in struct/union
 typedef struct _number
 {
-    int32_t sign;   // The sign of the mantissa, +1, or -1
-    int32_t cdigit; // The number of digits, or what passes for digits in the
-                    // radix being used.
-    int32_t exp;    // The offset of digits from the radix point
-                    // (decimal point in radix 10)
+    int32_t sign;      // The sign of the mantissa, +1, or -1
+    int32_t cdigit;    // The number of digits, or what passes for digits in the
+                       // radix being used.
+    int32_t exp;       // The offset of digits from the radix point
+                       // (decimal point in radix 10)
+    int32_t ccapacity; // The number of digits mant has room for, cdigit can
+                       // grow up to it in place.
     MANTTYPE mant[];
     // This is actually allocated as a continuation of the
     // NUMBER structure.
@@ -86,6 +88,10 @@ static constexpr uint32_t MAX_LONG_SIZE = 33; // Base 2 requires 32 'digits'
 // List of useful constants for evaluation, note this list needs to be
 // initialized.
 //
+// They are shared by every calculation and never change between calls to
+// ChangeConstants.  Routines read them in place, as the b argument or the
+// root of ratpowi32, and only DUPRAT one to change the copy.
+//
 //-----------------------------------------------------------------------------
 
 extern PNUMBER num_one;
@@ -130,16 +136,23 @@ extern PRAT rat_min_fact;
 extern PRAT rat_max_i32;
 extern PRAT rat_min_i32;
 
-// DUPNUM Duplicates a number taking care of allocation and internals
+// DUPNUM Duplicates a number taking care of allocation and internals, the
+// destination is reused when it has room.
 #define DUPNUM(a, b)                                                                                                                                           \
-    destroynum(a);                                                                                                                                             \
-    createnum(a, (b)->cdigit);                                                                                                                                 \
+    if ((a) == nullptr || (a)->ccapacity <= (b)->cdigit)                                                                                                       \
+    {                                                                                                                                                          \
+        destroynum(a);                                                                                                                                         \
+        createnum(a, (b)->cdigit);                                                                                                                             \
+    }                                                                                                                                                          \
     _dupnum(a, b);
 
-// DUPRAT Duplicates a rational taking care of allocation and internals
+// DUPRAT Duplicates a rational taking care of allocation and internals, the
+// destination and its numbers are reused when they have room.
 #define DUPRAT(a, b)                                                                                                                                           \
-    destroyrat(a);                                                                                                                                             \
-    createrat(a);                                                                                                                                              \
+    if ((a) == nullptr)                                                                                                                                        \
+    {                                                                                                                                                          \
+        createrat(a);                                                                                                                                          \
+    }                                                                                                                                                          \
     DUPNUM((a)->pp, (b)->pp);                                                                                                                                  \
     DUPNUM((a)->pq, (b)->pq);
 
@@ -158,6 +171,21 @@ extern PRAT rat_min_i32;
 // SIGN returns the sign of the rational
 #define SIGN(prat) ((prat)->pp->sign * (prat)->pq->sign)
 
+// RATPAK_POOL keeps the numbers and rationals a thread frees on free lists of
+// its own and hands them out again, build with it defined to 0 to take every
+// one from the heap.
+#if !defined(RATPAK_POOL)
+#define RATPAK_POOL 1
+#endif
+
+// RATPAK_TELEMETRY counts the calls and digits of the number kernels, the
+// heap bytes and live numbers of the allocator and the terms of every Taylor
+// series on each thread, build with it defined to 1 to read them with
+// getratpakstats.  Without it the counting compiles away.
+#if !defined(RATPAK_TELEMETRY)
+#define RATPAK_TELEMETRY 0
+#endif
+
 #if defined(DEBUG_RATPAK)
 //-----------------------------------------------------------------------------
 //
@@ -249,33 +277,17 @@ extern PRAT rat_min_i32;
         (x)->pq->exp -= trim;                                                                                                                                  \
     }
 
-#define SMALL_ENOUGH_RAT(a, precision) (zernum((a)->pp) || ((((a)->pq->cdigit + (a)->pq->exp) - ((a)->pp->cdigit + (a)->pp->exp) - 1) * g_ratio > precision))
-
 //-----------------------------------------------------------------------------
 //
-//   Defines for setting up taylor series expansions for infinite precision
-//   functions.
+//   Taylor series expansions for infinite precision functions are summed by
+//   sumseries, which is told x and the small factors of the term ratio
+//   x * num(j) / den(j).  Series whose terms are also weighted by a small
+//   factor a(k), the Chudnovsky series for pi, are summed by sumseriesfactor.
 //
 //-----------------------------------------------------------------------------
 
-#define CREATETAYLOR()                                                                                                                                         \
-    PRAT xx = nullptr;                                                                                                                                         \
-    PNUMBER n2 = nullptr;                                                                                                                                      \
-    PRAT pret = nullptr;                                                                                                                                       \
-    PRAT thisterm = nullptr;                                                                                                                                   \
-    DUPRAT(xx, *px);                                                                                                                                           \
-    mulrat(&xx, *px, precision);                                                                                                                               \
-    createrat(pret);                                                                                                                                           \
-    pret->pp = i32tonum(0L, BASEX);                                                                                                                            \
-    pret->pq = i32tonum(0L, BASEX);
-
-#define DESTROYTAYLOR()                                                                                                                                        \
-    destroynum(n2);                                                                                                                                            \
-    destroyrat(xx);                                                                                                                                            \
-    destroyrat(thisterm);                                                                                                                                      \
-    destroyrat(*px);                                                                                                                                           \
-    trimit(&pret, precision);                                                                                                                                  \
-    *px = pret;
+typedef void (*PFNTERMRATIO)(uint32_t j, uint64_t* pnum, uint64_t* pden);
+typedef uint64_t (*PFNTERMFACTOR)(uint32_t k);
 
 // INC(a) is the rational equivalent of a++
 // Check to see if we can avoid doing this the hard way.
@@ -290,23 +302,6 @@ extern PRAT rat_min_i32;
     }
 
 #define MSD(x) ((x)->mant[(x)->cdigit - 1])
-// MULNUM(b) is the rational equivalent of thisterm *= b where thisterm is
-// a rational and b is a number, NOTE this is a mixed type operation for
-// efficiency reasons.
-#define MULNUM(b) mulnumx(&(thisterm->pp), b);
-
-// DIVNUM(b) is the rational equivalent of thisterm /= b where thisterm is
-// a rational and b is a number, NOTE this is a mixed type operation for
-// efficiency reasons.
-#define DIVNUM(b) mulnumx(&(thisterm->pq), b);
-
-// NEXTTERM(p,d) is the rational equivalent of
-// thisterm *= p
-// d    <d is usually an expansion of operations to get thisterm updated.>
-// pret += thisterm
-#define NEXTTERM(p, d, precision)                                                                                                                              \
-    mulrat(&thisterm, p, precision);                                                                                                                           \
-    d addrat(&pret, thisterm, precision)
 
 //-----------------------------------------------------------------------------
 //
@@ -320,6 +315,21 @@ extern bool g_ftrueinfinite; // set to true to allow infinite precision
 
 extern int32_t g_ratio; // Internally calculated ratio of internal radix
 
+extern int32_t g_mulKaratsubaThreshold; // digits in the shorter operand from which mulnumx
+                                        // uses Karatsuba instead of grade school.
+extern int32_t g_mulToom3Threshold;     // digits in the shorter operand from which mulnumx
+                                        // uses Toom-3 instead of Karatsuba.
+extern int32_t g_mulNTTThreshold;       // digits in the shorter operand from which mulnumx
+                                        // uses a number theoretic transform.
+extern int32_t g_divBZThreshold;        // digits in the divisor and the quotient from which
+                                        // divnumx divides recursively.
+extern int32_t g_convDCThreshold;       // digits from which nRadixxtonum and numtonRadixx
+                                        // convert recursively.
+extern int32_t g_gcdThreshold;          // digits in p or in q from which addrat, mulrat
+                                        // and divrat reduce exact results.
+extern int32_t g_logAGMThreshold;       // digits of precision from which lograt uses the
+                                        // arithmetic-geometric mean instead of the series.
+
 //-----------------------------------------------------------------------------
 //
 //   External functions defined in the math package.
@@ -345,7 +355,7 @@ extern PNUMBER RatToNumber(_In_ PRAT prat, uint32_t radix, int32_t precision);
 // flattens a PRAT by converting it to a PNUMBER and back to a PRAT
 extern void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision);
 
-extern int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix);
+extern int32_t numtoi32(_In_ PNUMBER pnum, uint64_t radix);
 extern int32_t rattoi32(_In_ PRAT prat, uint32_t radix, int32_t precision);
 uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision);
 extern PNUMBER _createnum(_In_ uint32_t size); // returns an empty number structure with size digits
@@ -362,8 +372,8 @@ StringToRat(bool mantissaIsNegative, std::wstring_view mantissa, bool exponentIs
 
 extern PNUMBER i32factnum(int32_t ini32, uint32_t radix);
 extern PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix);
-extern PNUMBER i32tonum(int32_t ini32, uint32_t radix);
-extern PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix);
+extern PNUMBER i32tonum(int32_t ini32, uint64_t radix);
+extern PNUMBER Ui32tonum(uint32_t ini32, uint64_t radix);
 extern PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix);
 
 // creates a empty/undefined rational representation (p/q)
@@ -440,32 +450,113 @@ extern void tanrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void tananglerat(_Inout_ PRAT* px, AngleType angletype, uint32_t radix, int32_t precision);
 
 extern void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src);
+extern int32_t growcapacity(int32_t ccapacity, int32_t cdigit);
+extern bool alignnum(_Inout_ PNUMBER pnum, int32_t exp, int32_t cdigit);
 
 extern void _destroynum(_Frees_ptr_opt_ PNUMBER pnum);
 extern void _destroyrat(_Frees_ptr_opt_ PRAT prat);
-extern void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+
+extern void releasepool(); // gives the free lists of the calling thread back to the heap
+
+// The Taylor series counted by RATPAKSTATS, in the order ratpakstatstojson
+// names them.
+enum TAYLORSERIES
+{
+    TAYLOR_EXP,
+    TAYLOR_LOG,
+    TAYLOR_SIN,
+    TAYLOR_COS,
+    TAYLOR_SINH,
+    TAYLOR_COSH,
+    TAYLOR_ASIN,
+    TAYLOR_ACOS,
+    TAYLOR_ATAN,
+    TAYLOR_ASINH,
+    TAYLOR_ATANH,
+    TAYLOR_PI,
+    TAYLOR_COUNT
+};
+
+typedef struct _kernelstats
+{
+    uint64_t ccall;  // calls that did the work, not the shortcuts for 0 and 1
+    uint64_t cdigit; // digits of the operands of those calls
+} KERNELSTATS;
+
+// Work done by ratpak on the calling thread since the last
+// resetratpakstats, all zero unless built with RATPAK_TELEMETRY.
+typedef struct _ratpakstats
+{
+    KERNELSTATS mulnumx;
+    KERNELSTATS divnumx;
+    KERNELSTATS addnum;
+    KERNELSTATS trimit;
+    uint64_t cmalloc;             // blocks taken from the heap
+    uint64_t cbmalloc;            // bytes taken from the heap
+    uint64_t cfree;               // blocks given back to the heap
+    uint64_t creuse;              // blocks handed out again from the free lists
+    int64_t clivenum;             // numbers created and not yet destroyed
+    int64_t cpeaknum;             // most numbers alive at once
+    uint64_t cterm[TAYLOR_COUNT]; // terms summed by each series
+} RATPAKSTATS;
+
+extern RATPAKSTATS getratpakstats();
+extern void resetratpakstats(); // keeps the count of live numbers, the peak restarts from it
+extern std::string ratpakstatstojson(const RATPAKSTATS& stats);
+
+#if RATPAK_TELEMETRY
+extern thread_local RATPAKSTATS g_ratpakstats;
+
+#define COUNTKERNEL(kernel, digits)                                                                                                                            \
+    {                                                                                                                                                          \
+        g_ratpakstats.kernel.ccall++;                                                                                                                          \
+        g_ratpakstats.kernel.cdigit += (uint64_t)(digits);                                                                                                     \
+    }
+#define COUNTTERMS(series, count) g_ratpakstats.cterm[series] += (count)
+#else
+#define COUNTKERNEL(kernel, digits)
+#define COUNTTERMS(series, count) (void)(series)
+#endif
+
+// Brackets a top level operation, when the outermost scope on a thread ends
+// the blocks freed during the operation go back to the heap at once.
+class RatpakPoolScope
+{
+public:
+    RatpakPoolScope();
+    ~RatpakPoolScope();
+    RatpakPoolScope(const RatpakPoolScope&) = delete;
+    RatpakPoolScope& operator=(const RatpakPoolScope&) = delete;
+};
+
+extern void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void andrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
-extern void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precision);
+extern void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t precision);
 extern void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision);
 extern void divrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void fracrat(_Inout_ PRAT* pa, uint32_t radix, int32_t precision);
 extern void factrat(_Inout_ PRAT* pa, uint32_t radix, int32_t precision);
 extern void remrat(_Inout_ PRAT* pa, _In_ PRAT b);
 extern void modrat(_Inout_ PRAT* pa, _In_ PRAT b);
-extern void gcdrat(_Inout_ PRAT* pa, int32_t precision);
+extern void gcdrat(_Inout_ PRAT* pa);
 extern void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
-extern void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+extern void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b);
+extern void sqrnumx(_Inout_ PNUMBER* pa);
 extern void mulrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
-extern void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t precision);
+extern void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint64_t radix, int32_t precision);
 extern void numpowi32x(_Inout_ PNUMBER* proot, int32_t power);
+extern int32_t powwindow(int32_t cbits);
+extern bool rootnumx(_Inout_ PNUMBER* pa, int32_t n);
+extern void rootnum(_Inout_ PNUMBER* pa, int32_t n, int32_t cdigit);
 extern void orrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powratNumeratorDenominator(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powratcomp(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision);
-extern void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+extern void ratpowi32(_Inout_ PRAT* pret, _In_ PRAT root, int32_t power, int32_t precision);
+extern void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void rootrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void scale2pi(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void scale(_Inout_ PRAT* px, _In_ PRAT scalefact, uint32_t radix, int32_t precision);
@@ -473,6 +564,7 @@ extern void subrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void xorrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void lshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void rshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
+extern int32_t ratcmp(_In_ PRAT a, _In_ PRAT b); // -1, 0 or 1 as a < b, a == b or a > b
 extern bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision);
@@ -480,6 +572,10 @@ extern bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern void inbetween(_In_ PRAT* px, _In_ PRAT range, int32_t precision);
-extern void trimit(_Inout_ PRAT* px, int32_t precision);
+extern bool trimit(_Inout_ PRAT* px, int32_t precision);
+extern void keeptop(_Inout_ PNUMBER pnum, int32_t cdigit);
+extern double log2rat(_In_ PRAT prat); // log2 of abs(prat), from the top digits of p and q
+extern void sumseries(_Inout_ PRAT* px, _In_ PRAT x, PFNTERMRATIO pfnratio, TAYLORSERIES series, int32_t precision);
+extern void sumseriesfactor(_Inout_ PRAT* px, _In_ PRAT x, PFNTERMRATIO pfnratio, PFNTERMFACTOR pfnfactor, TAYLORSERIES series, int32_t precision);
 extern void _dumprawrat(_In_ const wchar_t* varname, _In_ PRAT rat, std::wostream& out);
 extern void _dumprawnum(_In_ const wchar_t* varname, _In_ PNUMBER num, std::wostream& out);
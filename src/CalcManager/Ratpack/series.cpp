@@ -0,0 +1,245 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           series.cpp
+//
+//
+//  Description
+//
+//     Contains the binary splitting evaluator the Taylor series of the
+//  transcendental functions are summed with.
+//
+//-----------------------------------------------------------------------------
+#include <cmath>
+#include <cstring> // for memmove
+#include "ratpak.h"
+
+using namespace std;
+
+// Keeps the top cdigit digits of the number, the digits below them are
+// dropped into the exponent.
+void keeptop(_Inout_ PNUMBER pnum, int32_t cdigit)
+{
+    int32_t cdrop = pnum->cdigit - cdigit;
+    if (!g_ftrueinfinite && cdrop > 0)
+    {
+        memmove(pnum->mant, pnum->mant + cdrop, cdigit * sizeof(MANTTYPE));
+        pnum->cdigit = cdigit;
+        pnum->exp += cdrop;
+    }
+}
+
+namespace
+{
+    // log2 of the magnitude of a number, from its top two digits.
+    double log2num(_In_ PNUMBER pnum)
+    {
+        int32_t cdigit = pnum->cdigit;
+        double top = pnum->mant[cdigit - 1];
+        if (cdigit > 1)
+        {
+            top += pnum->mant[cdigit - 2] / (double)BASEX;
+        }
+        return log2(top) + (double)BASEXPWR * (cdigit - 1 + pnum->exp);
+    }
+
+    // A BASEX number with the value of a 64 bit factor.
+    PNUMBER ui64tonum(uint64_t factor)
+    {
+        PNUMBER pnum = nullptr;
+        createnum(pnum, 2);
+        pnum->sign = 1;
+        pnum->exp = 0;
+        pnum->mant[0] = (MANTTYPE)factor;
+        pnum->mant[1] = (MANTTYPE)(factor >> BASEXPWR);
+        pnum->cdigit = (pnum->mant[1] != 0) ? 2 : 1;
+        return pnum;
+    }
+
+    void mulnumui64(_Inout_ PNUMBER* pa, uint64_t factor)
+    {
+        if (factor != 1)
+        {
+            PNUMBER pnum = ui64tonum(factor);
+            mulnumx(pa, pnum);
+            destroynum(pnum);
+        }
+    }
+
+    typedef struct _split
+    {
+        PNUMBER p; // product of the numerators of the ratios
+        PNUMBER q; // product of the denominators of the ratios
+        PNUMBER t; // q times the sum of the partial products of the ratios
+    } SPLIT;
+
+    //-----------------------------------------------------------------------------
+    //
+    //    FUNCTION: splitseries
+    //
+    //    ARGUMENTS: x, the term ratio factors, the term weights, the range
+    //    of ratios [jlo, jhi) and the digits to keep
+    //
+    //    RETURN: P, Q and T of the range
+    //
+    //    DESCRIPTION: With rj = x * num(j) / den(j), P/Q is the product of
+    //    rjlo through rjhi-1 and T/Q is rjlo + rjlo*rjlo+1 + ... + P/Q, each
+    //    product weighted by a(k) of the term it leads to when there are
+    //    weights.  The halves of the range are joined by
+    //
+    //       P = P1*P2,  Q = Q1*Q2,  T = T1*Q2 + P1*T2
+    //
+    //    Only P/Q and T/Q matter to the sum, so each is cut back to cdigit
+    //    digits, which bounds the numbers when x is long.
+    //
+    //-----------------------------------------------------------------------------
+
+    SPLIT splitseries(_In_ PRAT x, PFNTERMRATIO pfnratio, PFNTERMFACTOR pfnfactor, uint32_t jlo, uint32_t jhi, int32_t cdigit)
+    {
+        SPLIT split = { nullptr, nullptr, nullptr };
+        if (jhi - jlo == 1)
+        {
+            uint64_t num;
+            uint64_t den;
+            pfnratio(jlo, &num, &den);
+            DUPNUM(split.p, x->pp);
+            DUPNUM(split.q, x->pq);
+            mulnumui64(&split.p, num);
+            mulnumui64(&split.q, den);
+            split.p->sign *= split.q->sign;
+            split.q->sign = 1;
+            DUPNUM(split.t, split.p);
+            if (pfnfactor != nullptr)
+            {
+                mulnumui64(&split.t, pfnfactor(jlo + 1));
+            }
+        }
+        else
+        {
+            uint32_t jmid = jlo + (jhi - jlo) / 2;
+            split = splitseries(x, pfnratio, pfnfactor, jlo, jmid, cdigit);
+            SPLIT right = splitseries(x, pfnratio, pfnfactor, jmid, jhi, cdigit);
+
+            mulnumx(&split.t, right.q);
+            mulnumx(&right.t, split.p);
+            addnum(&split.t, right.t, BASEX);
+            mulnumx(&split.p, right.p);
+            mulnumx(&split.q, right.q);
+
+            destroynum(right.t);
+            destroynum(right.q);
+            destroynum(right.p);
+        }
+        keeptop(split.p, cdigit);
+        keeptop(split.q, cdigit);
+        keeptop(split.t, cdigit);
+        return split;
+    }
+}
+
+double log2rat(_In_ PRAT prat)
+{
+    return log2num(prat->pp) - log2num(prat->pq);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: sumseries
+//
+//    ARGUMENTS: pointer to the first term, x, the term ratio factors, the
+//    series for the telemetry and precision
+//
+//    RETURN: None, the first term is replaced with the sum
+//
+//    DESCRIPTION: Sums t0 + t1 + ... where tj+1 = tj * x * num(j) / den(j),
+//    up to the first term small enough for precision, the way NEXTTERM and
+//    SMALL_ENOUGH_RAT used to.  The number of terms is found up front from
+//    the magnitudes, and the sum
+//
+//       t0 * (Q + T) / Q
+//
+//    is built by binary splitting, so the ratios are multiplied together
+//    as numbers and there is a single rational operation at the end.
+//
+//-----------------------------------------------------------------------------
+
+void sumseries(_Inout_ PRAT* px, _In_ PRAT x, PFNTERMRATIO pfnratio, TAYLORSERIES series, int32_t precision)
+{
+    sumseriesfactor(px, x, pfnratio, nullptr, series, precision);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: sumseriesfactor
+//
+//    ARGUMENTS: pointer to the first term, x, the term ratio factors, the
+//    term weights or nullptr, the series for the telemetry and precision
+//
+//    RETURN: None, the first term is replaced with the weighted sum
+//
+//    DESCRIPTION: Sums a(0)*t0 + a(1)*t1 + ... the way sumseries sums the
+//    terms, as
+//
+//       t0 * (a(0)*Q + T) / Q
+//
+//    The weights are small factors such as the 13591409 + 545140134*k of
+//    the Chudnovsky series, which do not fit a ratio of the next term.
+//
+//-----------------------------------------------------------------------------
+
+void sumseriesfactor(_Inout_ PRAT* px, _In_ PRAT x, PFNTERMRATIO pfnratio, PFNTERMFACTOR pfnfactor, TAYLORSERIES series, int32_t precision)
+{
+    if (zerrat(*px) || zerrat(x))
+    {
+        if (pfnfactor != nullptr)
+        {
+            mulnumui64(&((*px)->pp), pfnfactor(0));
+        }
+        return;
+    }
+
+    // The terms stop once they are below BASEX**-(precision/g_ratio + 1),
+    // relative to the weight of the first.
+    const double smallenough = -(double)BASEXPWR * (precision / g_ratio + 2);
+    const double log2x = log2rat(x);
+    const double log2a0 = (pfnfactor != nullptr) ? log2((double)pfnfactor(0)) : 0;
+    double log2term = log2rat(*px);
+    double log2weight;
+    uint32_t cterm = 0;
+    do
+    {
+        uint64_t num;
+        uint64_t den;
+        pfnratio(cterm, &num, &den);
+        log2term += log2x + log2((double)num) - log2((double)den);
+        cterm++;
+        log2weight = (pfnfactor != nullptr) ? log2((double)pfnfactor(cterm)) - log2a0 : 0;
+    } while (log2term + log2weight >= smallenough);
+    COUNTTERMS(series, cterm);
+
+    const int32_t cdigit = precision / g_ratio + 3;
+    SPLIT split = splitseries(x, pfnratio, pfnfactor, 0, cterm, cdigit);
+
+    PRAT sum = nullptr;
+    createrat(sum);
+    if (pfnfactor != nullptr)
+    {
+        DUPNUM(split.p, split.q);
+        mulnumui64(&split.p, pfnfactor(0));
+        addnum(&split.t, split.p, BASEX);
+    }
+    else
+    {
+        addnum(&split.t, split.q, BASEX);
+    }
+    sum->pp = split.t;
+    sum->pq = split.q;
+    destroynum(split.p);
+    RENORMALIZE(sum);
+
+    mulrat(px, sum, precision);
+    destroyrat(sum);
+    trimit(px, precision);
+}
@@ -21,6 +21,7 @@
 #include <string>
 #include <cstring>  // for memmove
 #include <iostream> // for wostream
+#include <vector>
 #include "ratpak.h"
 
 using namespace std;
@@ -117,6 +118,146 @@ PRAT rat_min_fact = nullptr;
 PRAT rat_min_i32 = nullptr; // min signed i32
 PRAT rat_max_i32 = nullptr; // max signed i32
 
+namespace
+{
+    // The constants ChangeConstants computes from series.  Each set computed
+    // is kept, keyed by the BASEX digits of its precision, so going back to a
+    // precision never recomputes them, and a lower precision cuts back the
+    // closest longer set instead.
+    PRAT* const seriesconstants[] = { &pi, &two_pi, &pi_over_two, &one_pt_five_pi, &e_to_one_half, &rat_exp, &ln_two, &ln_ten, &rad_to_deg, &rad_to_grad };
+    constexpr size_t CSERIESCONSTANTS = sizeof(seriesconstants) / sizeof(seriesconstants[0]);
+
+    typedef struct _constanttier
+    {
+        int32_t cdigit; // BASEX digits of the precision the set was computed to
+        PRAT rat[CSERIESCONSTANTS];
+    } CONSTANTTIER;
+
+    std::vector<CONSTANTTIER> constanttiers;
+
+    // Sets the series constants from the shortest kept set of at least
+    // cdigit digits, cut back to precision.  Returns false if there is none.
+    bool readconstanttier(int32_t cdigit, int32_t precision)
+    {
+        const CONSTANTTIER* ptier = nullptr;
+        for (const CONSTANTTIER& tier : constanttiers)
+        {
+            if (tier.cdigit >= cdigit && (ptier == nullptr || tier.cdigit < ptier->cdigit))
+            {
+                ptier = &tier;
+            }
+        }
+        if (ptier == nullptr)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < CSERIESCONSTANTS; i++)
+        {
+            DUPRAT(*seriesconstants[i], ptier->rat[i]);
+            if (ptier->cdigit > cdigit)
+            {
+                trimit(seriesconstants[i], precision);
+            }
+        }
+        return true;
+    }
+
+    // Keeps the series constants as the set of cdigit digits.
+    void addconstanttier(int32_t cdigit)
+    {
+        CONSTANTTIER tier;
+        tier.cdigit = cdigit;
+        for (size_t i = 0; i < CSERIESCONSTANTS; i++)
+        {
+            tier.rat[i] = nullptr;
+            DUPRAT(tier.rat[i], *seriesconstants[i]);
+        }
+        constanttiers.push_back(tier);
+    }
+
+    // The next term of the Chudnovsky series is
+    // thisterm * x * (6j+1)(2j+1)(6j+5) / (j+1)**3, x is -24/640320**3.
+    void piratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = (6 * (uint64_t)j + 1) * (2 * (uint64_t)j + 1) * (6 * (uint64_t)j + 5);
+        *pden = ((uint64_t)j + 1) * ((uint64_t)j + 1) * ((uint64_t)j + 1);
+    }
+
+    // Each term of the Chudnovsky series is weighted by 13591409 + 545140134*k.
+    uint64_t pifactor(uint32_t k)
+    {
+        return 13591409 + 545140134 * (uint64_t)k;
+    }
+
+    // The next term of atanh is thisterm * x * (2j+1) / (2j+3), x is X**2.
+    void atanhratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 2 * (uint64_t)j + 1;
+        *pden = 2 * (uint64_t)j + 3;
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    //  FUNCTION: chudnovskypi
+    //
+    //  ARGUMENTS:  pointer to the rational to set, and precision to use.
+    //
+    //  RETURN: None, sets the rational to pi.
+    //
+    //  EXPLANATION: The Chudnovsky series
+    //
+    //                           426880 sqrt(10005)
+    //     pi = ---------------------------------------------------------
+    //           sum  (6k)! (13591409 + 545140134k) / ((3k)! (k!)^3 (-640320)^3k)
+    //
+    //  gains 14 decimal digits a term, and its small term ratios are
+    //  multiplied together by binary splitting.
+    //
+    //----------------------------------------------------------------------------
+
+    void chudnovskypi(_Inout_ PRAT* px, int32_t precision)
+    {
+        PRAT x = nullptr;
+        createrat(x);
+        x->pp = i32tonum(-24L, BASEX);
+        x->pq = i32tonum(640320L, BASEX);
+        numpowi32x(&(x->pq), 3);
+
+        PRAT sum = i32torat(1L);
+        sumseriesfactor(&sum, x, piratio, pifactor, TAYLOR_PI, precision);
+
+        PNUMBER root = i32tonum(10005L, BASEX);
+        rootnum(&root, 2, precision / g_ratio + 2);
+        destroyrat(*px);
+        *px = i32torat(426880L);
+        mulnumx(&((*px)->pp), root);
+        divrat(px, sum, precision);
+
+        destroynum(root);
+        destroyrat(sum);
+        destroyrat(x);
+    }
+
+    // Adds weight * atanh(1/n) to the rational, from its series.
+    void addatanhinv(_Inout_ PRAT* px, int32_t weight, int32_t n, int32_t precision)
+    {
+        PRAT x = nullptr;
+        createrat(x);
+        x->pp = i32tonum(1L, BASEX);
+        x->pq = i32tonum(n * n, BASEX);
+
+        PRAT term = i32torat(weight);
+        destroynum(term->pq);
+        term->pq = i32tonum(n, BASEX);
+        sumseries(&term, x, atanhratio, TAYLOR_ATANH, precision);
+        addrat(px, term, precision);
+
+        destroyrat(term);
+        destroyrat(x);
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 //  FUNCTION: ChangeConstants
@@ -141,7 +282,9 @@ void ChangeConstants(uint32_t radix, int32_t precision)
     destroyrat(rat_nRadix);
     rat_nRadix = i32torat(radix);
 
-    // Check to see what we have to recalculate and what we don't
+    // Check to see what we have to recalculate and what we don't.  The table
+    // in ratconst.h covers cbitsofprecision, anything past it comes from the
+    // kept sets or the series, since the table is read back over it below.
     if (cbitsofprecision < (g_ratio * static_cast<int32_t>(radix) * precision))
     {
         g_ftrueinfinite = false;
@@ -218,55 +361,64 @@ void ChangeConstants(uint32_t radix, int32_t precision)
         rat_min_exp->pp->sign *= -1;
         DUMPRAWRAT(rat_min_exp);
 
-        cbitsofprecision = g_ratio * radix * precision;
-
         // Apparently when dividing 180 by pi, another (internal) digit of
         // precision is needed.
         int32_t extraPrecision = precision + g_ratio;
-        DUPRAT(pi, rat_half);
-        asinrat(&pi, radix, extraPrecision);
-        mulrat(&pi, rat_six, extraPrecision);
-        DUMPRAWRAT(pi);
-
-        DUPRAT(two_pi, pi);
-        DUPRAT(pi_over_two, pi);
-        DUPRAT(one_pt_five_pi, pi);
-        addrat(&two_pi, pi, extraPrecision);
-        DUMPRAWRAT(two_pi);
-
-        divrat(&pi_over_two, rat_two, extraPrecision);
-        DUMPRAWRAT(pi_over_two);
-
-        addrat(&one_pt_five_pi, pi_over_two, extraPrecision);
-        DUMPRAWRAT(one_pt_five_pi);
-
-        DUPRAT(e_to_one_half, rat_half);
-        _exprat(&e_to_one_half, extraPrecision);
-        DUMPRAWRAT(e_to_one_half);
-
-        DUPRAT(rat_exp, rat_one);
-        _exprat(&rat_exp, extraPrecision);
-        DUMPRAWRAT(rat_exp);
-
-        // WARNING: remember lograt uses exponent constants calculated above...
-
-        DUPRAT(ln_ten, rat_ten);
-        lograt(&ln_ten, extraPrecision);
-        DUMPRAWRAT(ln_ten);
-
-        DUPRAT(ln_two, rat_two);
-        lograt(&ln_two, extraPrecision);
-        DUMPRAWRAT(ln_two);
-
-        destroyrat(rad_to_deg);
-        rad_to_deg = i32torat(180L);
-        divrat(&rad_to_deg, pi, extraPrecision);
-        DUMPRAWRAT(rad_to_deg);
-
-        destroyrat(rad_to_grad);
-        rad_to_grad = i32torat(200L);
-        divrat(&rad_to_grad, pi, extraPrecision);
-        DUMPRAWRAT(rad_to_grad);
+        const int32_t cdigit = extraPrecision / g_ratio + 1;
+        if (!readconstanttier(cdigit, extraPrecision))
+        {
+            chudnovskypi(&pi, extraPrecision);
+            DUMPRAWRAT(pi);
+
+            DUPRAT(two_pi, pi);
+            DUPRAT(pi_over_two, pi);
+            DUPRAT(one_pt_five_pi, pi);
+            addrat(&two_pi, pi, extraPrecision);
+            DUMPRAWRAT(two_pi);
+
+            divrat(&pi_over_two, rat_two, extraPrecision);
+            DUMPRAWRAT(pi_over_two);
+
+            addrat(&one_pt_five_pi, pi_over_two, extraPrecision);
+            DUMPRAWRAT(one_pt_five_pi);
+
+            DUPRAT(e_to_one_half, rat_half);
+            _exprat(&e_to_one_half, extraPrecision);
+            DUMPRAWRAT(e_to_one_half);
+
+            DUPRAT(rat_exp, rat_one);
+            _exprat(&rat_exp, extraPrecision);
+            DUMPRAWRAT(rat_exp);
+
+            // ln 2 = 18 atanh(1/26) - 2 atanh(1/4801) + 8 atanh(1/8749) and
+            // ln 10 = 3 ln 2 + 2 atanh(1/9), series in short x that converge fast.
+            DUPRAT(ln_two, rat_zero);
+            addatanhinv(&ln_two, 18L, 26L, extraPrecision);
+            addatanhinv(&ln_two, -2L, 4801L, extraPrecision);
+            addatanhinv(&ln_two, 8L, 8749L, extraPrecision);
+            trimit(&ln_two, extraPrecision);
+            DUMPRAWRAT(ln_two);
+
+            DUPRAT(ln_ten, ln_two);
+            PRAT three = i32torat(3L);
+            mulrat(&ln_ten, three, extraPrecision);
+            destroyrat(three);
+            addatanhinv(&ln_ten, 2L, 9L, extraPrecision);
+            trimit(&ln_ten, extraPrecision);
+            DUMPRAWRAT(ln_ten);
+
+            destroyrat(rad_to_deg);
+            rad_to_deg = i32torat(180L);
+            divrat(&rad_to_deg, pi, extraPrecision);
+            DUMPRAWRAT(rad_to_deg);
+
+            destroyrat(rad_to_grad);
+            rad_to_grad = i32torat(200L);
+            divrat(&rad_to_grad, pi, extraPrecision);
+            DUMPRAWRAT(rad_to_grad);
+
+            addconstanttier(cdigit);
+        }
     }
     else
     {
@@ -311,146 +463,117 @@ void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
     }
 }
 
+namespace
+{
+    // Digits of pnum up to its top nonzero one, counted from the radix point.
+    int32_t topdigit(_In_ PNUMBER pnum)
+    {
+        int32_t cdigit = pnum->cdigit;
+        while (cdigit > 1 && pnum->mant[cdigit - 1] == 0)
+        {
+            cdigit--;
+        }
+        return cdigit + pnum->exp;
+    }
+}
+
 //---------------------------------------------------------------------------
 //
-//  FUNCTION: rat_equ
+//  FUNCTION: ratcmp
 //
 //  ARGUMENTS:  PRAT a and PRAT b
 //
-//  RETURN: true if equal false otherwise.
+//  RETURN: -1, 0 or 1 as a is less than, equal to or greater than b.
 //
+//  DESCRIPTION: Decides from the signs first, then from the magnitudes.
+//  A rational with p and q of lp and lq digits lies strictly between
+//  BASEX^(lp-lq-1) and BASEX^(lp-lq+1), so when those exponents are two or
+//  more apart the larger one is the larger value.  Only the rest are cross
+//  multiplied, and neither a nor b is changed.
 //
 //---------------------------------------------------------------------------
 
-bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+int32_t ratcmp(_In_ PRAT a, _In_ PRAT b)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    rattmp->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    bool bret = zernum(rattmp->pp);
-    destroyrat(rattmp);
-    return (bret);
+    int32_t signa = zernum(a->pp) ? 0 : SIGN(a);
+    int32_t signb = zernum(b->pp) ? 0 : SIGN(b);
+    if (signa != signb)
+    {
+        return (signa < signb) ? -1 : 1;
+    }
+    if (signa == 0)
+    {
+        return 0;
+    }
+
+    int32_t cmp;
+    int32_t diff = (topdigit(a->pp) - topdigit(a->pq)) - (topdigit(b->pp) - topdigit(b->pq));
+    if (diff >= 2 || diff <= -2)
+    {
+        cmp = (diff > 0) ? 1 : -1;
+    }
+    else if (equnum(a->pq, b->pq))
+    {
+        cmp = equnum(a->pp, b->pp) ? 0 : (lessnum(a->pp, b->pp) ? -1 : 1);
+    }
+    else
+    {
+        // |pa| * |qb| against |pb| * |qa|
+        PNUMBER left = nullptr;
+        PNUMBER right = nullptr;
+        DUPNUM(left, a->pp);
+        DUPNUM(right, b->pp);
+        mulnumx(&left, b->pq);
+        mulnumx(&right, a->pq);
+        cmp = equnum(left, right) ? 0 : (lessnum(left, right) ? -1 : 1);
+        destroynum(right);
+        destroynum(left);
+    }
+    return cmp * signa;
 }
 
 //---------------------------------------------------------------------------
 //
-//  FUNCTION: rat_ge
+//  FUNCTION: rat_equ, rat_neq, rat_gt, rat_ge, rat_lt, rat_le
 //
 //  ARGUMENTS:  PRAT a, PRAT b and int32_t precision
 //
-//  RETURN: true if a is greater than or equal to b
+//  RETURN: true if a compares with b as the name says.
 //
+//  DESCRIPTION: The comparisons are exact, precision is not needed by
+//  ratcmp and is kept for the callers.
 //
 //---------------------------------------------------------------------------
 
-bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t precision)
-
+bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (zernum(rattmp->pp) || SIGN(rattmp) == 1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) == 0;
 }
 
-//---------------------------------------------------------------------------
-//
-//  FUNCTION: rat_gt
-//
-//  ARGUMENTS:  PRAT a and PRAT b
-//
-//  RETURN: true if a is greater than b
-//
-//
-//---------------------------------------------------------------------------
-
-bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
-
+bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (!zernum(rattmp->pp) && SIGN(rattmp) == 1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) != 0;
 }
 
-//---------------------------------------------------------------------------
-//
-//  FUNCTION: rat_le
-//
-//  ARGUMENTS:  PRAT a, PRAT b and int32_t precision
-//
-//  RETURN: true if a is less than or equal to b
-//
-//
-//---------------------------------------------------------------------------
-
-bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t precision)
-
+bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (zernum(rattmp->pp) || SIGN(rattmp) == -1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) > 0;
 }
 
-//---------------------------------------------------------------------------
-//
-//  FUNCTION: rat_lt
-//
-//  ARGUMENTS:  PRAT a, PRAT b and int32_t precision
-//
-//  RETURN: true if a is less than b
-//
-//
-//---------------------------------------------------------------------------
-
-bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
-
+bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (!zernum(rattmp->pp) && SIGN(rattmp) == -1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) >= 0;
 }
 
-//---------------------------------------------------------------------------
-//
-//  FUNCTION: rat_neq
-//
-//  ARGUMENTS:  PRAT a and PRAT b
-//
-//  RETURN: true if a is not equal to b
-//
-//
-//---------------------------------------------------------------------------
-
-bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
+{
+    return ratcmp(a, b) < 0;
+}
 
+bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    rattmp->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    bool bret = !(zernum(rattmp->pp));
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) <= 0;
 }
 
 //---------------------------------------------------------------------------
@@ -514,15 +637,13 @@ void scale2pi(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
         mulrat(&my_two_pi, rat_six, precision);
         mulrat(&my_two_pi, rat_two, precision);
     }
-    else
-    {
-        DUPRAT(my_two_pi, two_pi);
-        logscale = 0;
-    }
 
-    divrat(&pret, my_two_pi, precision);
+    // Otherwise the constant is precise enough, and only read.
+    PRAT scale_two_pi = (my_two_pi != nullptr) ? my_two_pi : two_pi;
+
+    divrat(&pret, scale_two_pi, precision);
     intrat(&pret, radix, precision);
-    mulrat(&pret, my_two_pi, precision);
+    mulrat(&pret, scale_two_pi, precision);
     pret->pp->sign *= -1;
     addrat(px, pret, precision);
 
@@ -594,6 +715,7 @@ void _dumprawnum(_In_ const wchar_t* varname, _In_ PNUMBER num, wostream& out)
     out << L"\t" << num->sign << L",\n";
     out << L"\t" << num->cdigit << L",\n";
     out << L"\t" << num->exp << L",\n";
+    out << L"\t" << num->cdigit << L",\n";
     out << L"\t{ ";
 
     for (int i = 0; i < num->cdigit; i++)
@@ -663,18 +785,23 @@ void _readconstants(void)
 //  n-1 digits of accuracy.  This dramatically speeds up calculations
 //  involving hundreds of digits or more.
 //  The last part of this trim dealing with exponents never affects accuracy
+//  The kept digits are moved down to mant[0] rather than remembered at an
+//  offset, they are only a few limbs more than precision and the move is
+//  lost in the multiply and divide that made them.
 //
-//  RETURN: none, modifies the pointed to PRAT
+//  RETURN: true if digits were chopped off, modifies the pointed to PRAT
 //
 //---------------------------------------------------------------------------
 
-void trimit(_Inout_ PRAT* px, int32_t precision)
+bool trimit(_Inout_ PRAT* px, int32_t precision)
 
 {
+    bool ftrimmed = false;
     if (!g_ftrueinfinite)
     {
         PNUMBER pp = (*px)->pp;
         PNUMBER pq = (*px)->pq;
+        COUNTKERNEL(trimit, pp->cdigit + pq->cdigit);
         int32_t trim = g_ratio * (min((pp->cdigit + pp->exp), (pq->cdigit + pq->exp)) - 1) - precision;
         if (trim > g_ratio)
         {
@@ -701,9 +828,11 @@ void trimit(_Inout_ PRAT* px, int32_t precision)
                 pq->cdigit -= trim - pq->exp;
                 pq->exp = 0;
             }
+            ftrimmed = true;
         }
         trim = min(pp->exp, pq->exp);
         pp->exp -= trim;
         pq->exp -= trim;
     }
+    return ftrimmed;
 }
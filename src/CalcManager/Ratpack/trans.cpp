@@ -16,6 +16,23 @@
 
 #include "ratpak.h"
 
+namespace
+{
+    // The next term of sin is thisterm * -x^2 / ((2j+2)*(2j+3)).
+    void sinratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 1;
+        *pden = (2 * (uint64_t)j + 2) * (2 * (uint64_t)j + 3);
+    }
+
+    // The next term of cos is thisterm * -x^2 / ((2j+1)*(2j+2)).
+    void cosratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 1;
+        *pden = (2 * (uint64_t)j + 1) * (2 * (uint64_t)j + 2);
+    }
+}
+
 void scalerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t precision)
 {
     switch (angletype)
@@ -66,20 +83,13 @@ void scalerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t pre
 void _sinrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
-
-    DUPNUM(n2, num_one);
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
     xx->pp->sign *= -1;
 
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-    DESTROYTAYLOR();
+    sumseries(px, xx, sinratio, TAYLOR_SIN, precision);
+    destroyrat(xx);
 
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
@@ -155,28 +165,17 @@ void sinanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
 //
 //-----------------------------------------------------------------------------
 
-void _cosrat(PRAT* px, uint32_t radix, int32_t precision)
+void _cosrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    destroynum(pret->pp);
-    destroynum(pret->pq);
-
-    pret->pp = i32tonum(1L, radix);
-    pret->pq = i32tonum(1L, radix);
-
-    DUPRAT(thisterm, pret)
-
-    n2 = i32tonum(0L, radix);
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
     xx->pp->sign *= -1;
+    DUPRAT(*px, rat_one);
 
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-    DESTROYTAYLOR();
+    sumseries(px, xx, cosratio, TAYLOR_COS, precision);
+    destroyrat(xx);
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
     inbetween(px, rat_one, precision);
@@ -190,7 +189,7 @@ void _cosrat(PRAT* px, uint32_t radix, int32_t precision)
 void cosrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 {
     scale2pi(px, radix, precision);
-    _cosrat(px, radix, precision);
+    _cosrat(px, precision);
 }
 
 void cosanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t precision)
@@ -224,7 +223,7 @@ void cosanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
         mulrat(pa, pi, precision);
         break;
     }
-    _cosrat(pa, radix, precision);
+    _cosrat(pa, precision);
 }
 
 //-----------------------------------------------------------------------------
@@ -239,14 +238,14 @@ void cosanglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
 //
 //-----------------------------------------------------------------------------
 
-void _tanrat(PRAT* px, uint32_t radix, int32_t precision)
+void _tanrat(PRAT* px, int32_t precision)
 
 {
     PRAT ptmp = nullptr;
 
     DUPRAT(ptmp, *px);
     _sinrat(px, precision);
-    _cosrat(&ptmp, radix, precision);
+    _cosrat(&ptmp, precision);
     if (zerrat(ptmp))
     {
         destroyrat(ptmp);
@@ -260,7 +259,7 @@ void _tanrat(PRAT* px, uint32_t radix, int32_t precision)
 void tanrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 {
     scale2pi(px, radix, precision);
-    _tanrat(px, radix, precision);
+    _tanrat(px, precision);
 }
 
 void tananglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t precision)
@@ -286,5 +285,5 @@ void tananglerat(_Inout_ PRAT* pa, AngleType angletype, uint32_t radix, int32_t
         mulrat(pa, pi, precision);
         break;
     }
-    _tanrat(pa, radix, precision);
+    _tanrat(pa, precision);
 }
@@ -16,6 +16,23 @@
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
 
+namespace
+{
+    // The next term of sinh is thisterm * x^2 / ((2j+2)*(2j+3)).
+    void sinhratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 1;
+        *pden = (2 * (uint64_t)j + 2) * (2 * (uint64_t)j + 3);
+    }
+
+    // The next term of cosh is thisterm * x^2 / ((2j+1)*(2j+2)).
+    void coshratio(uint32_t j, uint64_t* pnum, uint64_t* pden)
+    {
+        *pnum = 1;
+        *pden = (2 * (uint64_t)j + 1) * (2 * (uint64_t)j + 2);
+    }
+}
+
 bool IsValidForHypFunc(PRAT px, int32_t precision)
 {
     PRAT ptmp = nullptr;
@@ -73,19 +90,12 @@ void _sinhrat(PRAT* px, int32_t precision)
         throw(CALC_E_DOMAIN);
     }
 
-    CREATETAYLOR();
-
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, pret);
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
 
-    DUPNUM(n2, num_one);
-
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
-
-    DESTROYTAYLOR();
+    sumseries(px, xx, sinhratio, TAYLOR_SINH, precision);
+    destroyrat(xx);
 }
 
 void sinhrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
@@ -143,7 +153,7 @@ void sinhrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 //
 //-----------------------------------------------------------------------------
 
-void _coshrat(PRAT* px, uint32_t radix, int32_t precision)
+void _coshrat(PRAT* px, int32_t precision)
 
 {
     if (!IsValidForHypFunc(*px, precision))
@@ -152,21 +162,13 @@ void _coshrat(PRAT* px, uint32_t radix, int32_t precision)
         throw(CALC_E_DOMAIN);
     }
 
-    CREATETAYLOR();
-
-    pret->pp = i32tonum(1L, radix);
-    pret->pq = i32tonum(1L, radix);
-
-    DUPRAT(thisterm, pret)
-
-    n2 = i32tonum(0L, radix);
-
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    PRAT xx = nullptr;
+    DUPRAT(xx, *px);
+    mulrat(&xx, *px, precision);
+    DUPRAT(*px, rat_one);
 
-    DESTROYTAYLOR();
+    sumseries(px, xx, coshratio, TAYLOR_COSH, precision);
+    destroyrat(xx);
 }
 
 void coshrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
@@ -188,7 +190,7 @@ void coshrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
     }
     else
     {
-        _coshrat(px, radix, precision);
+        _coshrat(px, precision);
     }
     // Since *px might be epsilon below 1 due to TRIMIT
     // we need this trick here.
@@ -216,6 +216,173 @@ TEST_METHOD(TestRemainderRational)
     res = Rational(-834345) % Rational(Number(1, 0, { 103 }), Number(1, 0, { 100 }));
     VERIFY_ARE_EQUAL(res.ToString(10, NumberFormat::Float, 8), L"-0.71");
 }
+
+TEST_METHOD(TestNegativeBaseUnreducedExponent)
+{
+    // Exponents are reduced before the sign of a negative base is decided,
+    // so 2/6 acts as 1/3 and -22/2 as -11.
+    auto res = Pow(Rational(-8), Rational(2) / Rational(6));
+    VERIFY_ARE_EQUAL(res.ToString(10, NumberFormat::Float, 8), L"-2");
+    res = Pow(Rational(-9) / Rational(7), Rational(-22) / Rational(2));
+    VERIFY_ARE_EQUAL(res, Pow(Rational(-9) / Rational(7), Rational(-11)));
+    VERIFY_IS_TRUE(res < 0);
+    res = Root(Rational(-27516) / Rational(100), Rational(14) / Rational(6));
+    VERIFY_ARE_EQUAL(res, Root(Rational(-27516) / Rational(100), Rational(7) / Rational(3)));
+    VERIFY_ARE_EQUAL(res.ToString(10, NumberFormat::Float, 32), L"-11.105460134973049399444454827279");
+
+    // -38/4 is -19/2, an even root of a negative number.
+    try
+    {
+        res = Pow(Rational(-134), Rational(-38) / Rational(4));
+        Assert::Fail();
+    }
+    catch (uint32_t t)
+    {
+        if (t != CALC_E_DOMAIN)
+        {
+            Assert::Fail();
+        }
+    }
+    catch (...)
+    {
+        Assert::Fail();
+    }
+}
+
+TEST_METHOD(TestRootOfNegativeZero)
+{
+    // Negating a zero gives a negative zero, its roots are zero and not a
+    // domain error.
+    for (int32_t root : { 2, 3, 4 })
+    {
+        auto res = Root(-Rational{ 0 }, Rational(root));
+        VERIFY_ARE_EQUAL(res, 0);
+        VERIFY_ARE_EQUAL(res.ToString(10, NumberFormat::Float, 8), L"0");
+    }
+}
+
+TEST_METHOD(TestOperandsAliasEachOther)
+{
+    // The operators work on the Ratpack form in place, an operand that is
+    // the object itself has to give the same result as a copy of it.
+    Rational third = Rational(1) / Rational(3);
+    Rational rat = third;
+    rat += rat;
+    VERIFY_ARE_EQUAL(rat, third * 2);
+    rat -= rat;
+    VERIFY_ARE_EQUAL(rat, 0);
+    rat = third;
+    rat *= rat;
+    VERIFY_ARE_EQUAL(rat, Rational(1) / Rational(9));
+    rat /= rat;
+    VERIFY_ARE_EQUAL(rat, 1);
+    VERIFY_ARE_EQUAL(third, Rational(1) / Rational(3));
+
+    // Copies don't share their numbers.
+    Rational copy = third;
+    copy += 1;
+    VERIFY_ARE_EQUAL(third.ToString(10, NumberFormat::Float, 8), L"0.33333333");
+    VERIFY_ARE_EQUAL(copy.ToString(10, NumberFormat::Float, 8), L"1.3333333");
+    VERIFY_ARE_EQUAL(Abs(-third), third);
+}
+
+TEST_METHOD(TestSmallValuesMatchRatpack)
+{
+    // Values that fit in 64 bits are worked on as native integers, the
+    // results, signs of p and q included, have to be those of the Ratpack routines.
+    auto verifySame = [](Rational const& result, PRAT expected) {
+        Rational ratpackResult{ expected };
+        VERIFY_ARE_EQUAL(result, ratpackResult);
+        VERIFY_ARE_EQUAL(result.P().Sign(), expected->pp->sign);
+        VERIFY_ARE_EQUAL(result.Q().Sign(), expected->pq->sign);
+        VERIFY_ARE_EQUAL(result.ToString(10, NumberFormat::Float, 128), ratpackResult.ToString(10, NumberFormat::Float, 128));
+        destroyrat(expected);
+    };
+
+    auto ratpack = [](Rational const& a, Rational const& b, void (*op)(PRAT*, PRAT, int32_t)) {
+        PRAT pa = a.ToPRAT();
+        PRAT pb = b.ToPRAT();
+        op(&pa, pb, RATIONAL_PRECISION);
+        destroyrat(pb);
+        return pa;
+    };
+
+    Rational big = Rational(uint64_t{ INT64_MAX });
+    std::vector<Rational> values{ 0, 1, -1, 7, -12, Rational(1) / Rational(3), Rational(-5) / Rational(6), Rational(4294967296u) - 1, big, -big, big / Rational(9) };
+    values.push_back(Rational(Number(1, 0, { 250 }), Number(-1, 0, { 100 })));
+    for (auto const& a : values)
+    {
+        for (auto const& b : values)
+        {
+            verifySame(a + b, ratpack(a, b, addrat));
+            verifySame(a - b, ratpack(a, b, subrat));
+            verifySame(a * b, ratpack(a, b, mulrat));
+            if (b != 0)
+            {
+                verifySame(a / b, ratpack(a, b, divrat));
+            }
+
+            PRAT pa = a.ToPRAT();
+            PRAT pb = b.ToPRAT();
+            VERIFY_ARE_EQUAL(a < b, rat_lt(pa, pb, RATIONAL_PRECISION));
+            destroyrat(pa);
+            destroyrat(pb);
+        }
+    }
+}
+
+TEST_METHOD(TestMoveAndInPlace)
+{
+    Rational third = Rational(1) / Rational(3);
+    Rational big = Rational(uint64_t{ UINT64_MAX }) * third;
+    for (auto const& value : { third, big, -big })
+    {
+        Rational copy = value;
+        Rational moved = std::move(copy);
+        VERIFY_ARE_EQUAL(moved, value);
+        VERIFY_ARE_EQUAL(copy, 0);
+
+        copy = std::move(moved);
+        VERIFY_ARE_EQUAL(copy, value);
+        VERIFY_ARE_EQUAL(moved, 0);
+        VERIFY_ARE_EQUAL(-std::move(copy), -value);
+    }
+
+    // The InPlace forms give what the functions return.
+    Rational rat = third;
+    SinInPlace(rat, AngleType::Radians);
+    VERIFY_ARE_EQUAL(rat, Sin(third, AngleType::Radians));
+    rat = 8;
+    RootInPlace(rat, 3);
+    VERIFY_ARE_EQUAL(rat, 2);
+    Log10InPlace(rat);
+    VERIFY_ARE_EQUAL(rat, Log10(2));
+    rat = -big;
+    AbsInPlace(rat);
+    VERIFY_ARE_EQUAL(rat, big);
+}
+
+TEST_METHOD(TestNumberMantissaRoundTrip)
+{
+    // Mantissas up to DigitBuffer::INLINE_DIGITS live in the Number itself,
+    // longer ones spill to the heap, both have to come back unchanged.
+    for (size_t digits : { size_t{ 1 }, DigitBuffer::INLINE_DIGITS, DigitBuffer::INLINE_DIGITS + 1, 3 * DigitBuffer::INLINE_DIGITS })
+    {
+        Rational rat = 1;
+        for (size_t i = 0; i < digits; i++)
+        {
+            rat = rat * 4294967291u + static_cast<uint32_t>(i);
+        }
+        Number p = rat.P();
+        VERIFY_ARE_EQUAL(digits, p.Mantissa().size());
+
+        Number copy = p;
+        Number moved = std::move(copy);
+        VERIFY_ARE_EQUAL(p.Mantissa().size(), moved.Mantissa().size());
+        VERIFY_IS_TRUE(std::equal(p.Mantissa().begin(), p.Mantissa().end(), moved.Mantissa().begin()));
+        VERIFY_ARE_EQUAL(rat, Rational(moved, rat.Q()));
+    }
+}
 }
 ;
 }
@@ -0,0 +1,1266 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "Ratpack/ratpak.h"
+
+using namespace std;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    // Fills a BASEX number with pseudo random digits, the same seed always
+    // gives the same number.
+    PNUMBER MakeNumber(int32_t cdigit, uint32_t seed)
+    {
+        PNUMBER pnum = nullptr;
+        createnum(pnum, cdigit);
+        pnum->cdigit = cdigit;
+        pnum->sign = 1;
+        pnum->exp = 0;
+        uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            pnum->mant[i] = (MANTTYPE)((state >> 32) & (BASEX - 1));
+        }
+        if (pnum->mant[cdigit - 1] == 0)
+        {
+            pnum->mant[cdigit - 1] = 1;
+        }
+        return pnum;
+    }
+
+    PNUMBER MakeAllOnes(int32_t cdigit)
+    {
+        PNUMBER pnum = MakeNumber(cdigit, 0);
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            pnum->mant[i] = (MANTTYPE)(BASEX - 1);
+        }
+        return pnum;
+    }
+
+    // Moves pnum into a number with room for at least cdigit digits.
+    PNUMBER WithRoom(PNUMBER pnum, int32_t cdigit)
+    {
+        PNUMBER roomy = nullptr;
+        createnum(roomy, max(cdigit, pnum->cdigit));
+        _dupnum(roomy, pnum);
+        destroynum(pnum);
+        return roomy;
+    }
+
+    bool AreIdentical(PNUMBER a, PNUMBER b)
+    {
+        return a->sign == b->sign && a->exp == b->exp && a->cdigit == b->cdigit && memcmp(a->mant, b->mant, a->cdigit * sizeof(MANTTYPE)) == 0;
+    }
+
+    // Selects the multiplication tiers for the lifetime of the object.
+    class MulThresholds
+    {
+    public:
+        MulThresholds(int32_t karatsuba, int32_t toom3, int32_t ntt)
+            : m_karatsuba(g_mulKaratsubaThreshold)
+            , m_toom3(g_mulToom3Threshold)
+            , m_ntt(g_mulNTTThreshold)
+        {
+            g_mulKaratsubaThreshold = karatsuba;
+            g_mulToom3Threshold = toom3;
+            g_mulNTTThreshold = ntt;
+        }
+        ~MulThresholds()
+        {
+            g_mulKaratsubaThreshold = m_karatsuba;
+            g_mulToom3Threshold = m_toom3;
+            g_mulNTTThreshold = m_ntt;
+        }
+
+    private:
+        int32_t m_karatsuba;
+        int32_t m_toom3;
+        int32_t m_ntt;
+    };
+
+    PNUMBER Multiply(PNUMBER a, PNUMBER b, int32_t karatsuba, int32_t toom3, int32_t ntt = INT32_MAX)
+    {
+        MulThresholds thresholds(karatsuba, toom3, ntt);
+        PNUMBER result = nullptr;
+        DUPNUM(result, a);
+        mulnumx(&result, b);
+        return result;
+    }
+
+    // Multiplies every pair of lengths with the grade school algorithm and with
+    // the given thresholds and checks the answers are digit for digit the same.
+    void VerifyMatchesSchoolbook(const vector<pair<int32_t, int32_t>>& lengths, int32_t karatsuba, int32_t toom3, int32_t ntt = INT32_MAX)
+    {
+        uint32_t seed = 1;
+        for (const auto& length : lengths)
+        {
+            PNUMBER a = MakeNumber(length.first, seed++);
+            PNUMBER b = MakeNumber(length.second, seed++);
+            a->sign = -1;
+            a->exp = 3;
+            b->exp = -7;
+
+            PNUMBER expected = Multiply(a, b, INT32_MAX, INT32_MAX);
+            PNUMBER actual = Multiply(a, b, karatsuba, toom3, ntt);
+            VERIFY_IS_TRUE(AreIdentical(expected, actual));
+            destroynum(actual);
+
+            // and the other way around
+            actual = Multiply(b, a, karatsuba, toom3, ntt);
+            VERIFY_IS_TRUE(AreIdentical(expected, actual));
+
+            destroynum(actual);
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+        }
+    }
+
+    PNUMBER MakeNumber(initializer_list<MANTTYPE> digits)
+    {
+        PNUMBER pnum = MakeNumber((int32_t)digits.size(), 0);
+        copy(digits.begin(), digits.end(), pnum->mant);
+        return pnum;
+    }
+
+    // Checks c is a / b cut off after its last digit, for positive a and b:
+    // c * b <= a < (c + BASEX**c->exp) * b
+    void VerifyQuotient(PNUMBER a, PNUMBER b, PNUMBER c)
+    {
+        PNUMBER low = nullptr;
+        DUPNUM(low, c);
+        mulnumx(&low, b);
+        VERIFY_IS_FALSE(lessnum(a, low));
+
+        PNUMBER unit = i32tonum(1, BASEX);
+        unit->exp = c->exp;
+        PNUMBER high = nullptr;
+        DUPNUM(high, c);
+        addnum(&high, unit, BASEX);
+        mulnumx(&high, b);
+        VERIFY_IS_TRUE(lessnum(a, high));
+
+        destroynum(high);
+        destroynum(unit);
+        destroynum(low);
+    }
+
+    PNUMBER Divide(PNUMBER a, PNUMBER b, int32_t precision, int32_t bz = INT32_MAX)
+    {
+        int32_t savedbz = g_divBZThreshold;
+        g_divBZThreshold = bz;
+        PNUMBER result = nullptr;
+        DUPNUM(result, a);
+        divnumx(&result, b, precision);
+        g_divBZThreshold = savedbz;
+        return result;
+    }
+
+    // A number in the given radix with pseudo random digits.
+    PNUMBER MakeRadixNumber(int32_t cdigit, uint32_t seed, uint64_t radix)
+    {
+        PNUMBER pnum = MakeNumber(cdigit, seed);
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            pnum->mant[i] = (MANTTYPE)(pnum->mant[i] % radix);
+        }
+        if (pnum->mant[cdigit - 1] == 0)
+        {
+            pnum->mant[cdigit - 1] = 1;
+        }
+        return pnum;
+    }
+    PNUMBER ToBaseX(PNUMBER a, uint32_t radix, int32_t dc = INT32_MAX)
+    {
+        int32_t saveddc = g_convDCThreshold;
+        g_convDCThreshold = dc;
+        PNUMBER result = numtonRadixx(a, radix);
+        g_convDCThreshold = saveddc;
+        return result;
+    }
+
+    PNUMBER FromBaseX(PNUMBER a, uint32_t radix, int32_t dc = INT32_MAX)
+    {
+        int32_t saveddc = g_convDCThreshold;
+        g_convDCThreshold = dc;
+        PNUMBER result = nRadixxtonum(a, radix, 10000);
+        g_convDCThreshold = saveddc;
+        return result;
+    }
+
+    // The G.C.D. of positive integers a and b by Euclid's algorithm.
+    PNUMBER EuclidGcd(PNUMBER a, PNUMBER b)
+    {
+        PNUMBER x = nullptr;
+        PNUMBER y = nullptr;
+        DUPNUM(x, a);
+        DUPNUM(y, b);
+        while (!zernum(y))
+        {
+            remnum(&x, y, BASEX);
+            swap(x, y);
+        }
+        destroynum(y);
+        return x;
+    }
+}
+
+namespace CalculatorEngineTests
+{
+    TEST_CLASS(RatpackTest)
+    {
+    public:
+        TEST_CLASS_INITIALIZE(CommonSetup)
+        {
+            ChangeConstants(10, 128);
+        }
+
+        TEST_METHOD(MulKaratsubaMatchesSchoolbook)
+        {
+            VerifyMatchesSchoolbook({ { 4, 4 }, { 5, 4 }, { 7, 5 }, { 16, 16 }, { 17, 16 }, { 33, 20 }, { 64, 63 }, { 100, 99 }, { 257, 200 } }, 4, INT32_MAX);
+            VerifyMatchesSchoolbook({ { 40, 40 }, { 79, 41 }, { 150, 150 }, { 301, 299 } }, 32, INT32_MAX);
+        }
+
+        TEST_METHOD(MulToom3MatchesSchoolbook)
+        {
+            VerifyMatchesSchoolbook({ { 9, 9 }, { 10, 9 }, { 11, 9 }, { 12, 12 }, { 27, 19 }, { 50, 50 }, { 81, 80 }, { 128, 100 } }, 9, 9);
+            VerifyMatchesSchoolbook({ { 9, 9 }, { 30, 30 }, { 31, 22 }, { 200, 199 }, { 301, 299 } }, 4, 9);
+            VerifyMatchesSchoolbook({ { 400, 400 }, { 601, 550 } }, 32, 128);
+        }
+
+        TEST_METHOD(MulUnbalancedMatchesSchoolbook)
+        {
+            VerifyMatchesSchoolbook({ { 8, 4 }, { 9, 4 }, { 100, 7 }, { 301, 40 }, { 500, 200 } }, 4, 9);
+        }
+
+        TEST_METHOD(MulCarryHeavyOperands)
+        {
+            // (BASEX**n - 1)**2 == BASEX**2n - 2*BASEX**n + 1, which is 1, then
+            // n-1 zero digits, then BASEX-2, then n-1 digits of BASEX-1.
+            for (int32_t cdigit : { 4, 9, 33, 130, 400 })
+            {
+                PNUMBER a = MakeAllOnes(cdigit);
+                PNUMBER product = Multiply(a, a, 4, 9);
+
+                VERIFY_ARE_EQUAL(2 * cdigit, product->cdigit);
+                VERIFY_ARE_EQUAL(1u, (uint32_t)product->mant[0]);
+                for (int32_t i = 1; i < cdigit; i++)
+                {
+                    VERIFY_ARE_EQUAL(0u, (uint32_t)product->mant[i]);
+                }
+                VERIFY_ARE_EQUAL((uint32_t)(BASEX - 2), (uint32_t)product->mant[cdigit]);
+                for (int32_t i = cdigit + 1; i < 2 * cdigit; i++)
+                {
+                    VERIFY_ARE_EQUAL((uint32_t)(BASEX - 1), (uint32_t)product->mant[i]);
+                }
+
+                PNUMBER expected = Multiply(a, a, INT32_MAX, INT32_MAX);
+                VERIFY_IS_TRUE(AreIdentical(expected, product));
+
+                destroynum(expected);
+                destroynum(product);
+                destroynum(a);
+            }
+        }
+
+        TEST_METHOD(MulNTTMatchesSchoolbook)
+        {
+            VerifyMatchesSchoolbook({ { 1, 1 }, { 2, 1 }, { 3, 3 }, { 17, 16 }, { 64, 64 }, { 100, 3 }, { 513, 511 }, { 1000, 999 } }, INT32_MAX, INT32_MAX, 1);
+            VerifyMatchesSchoolbook({ { 2100, 2048 }, { 3000, 700 } }, 32, 160, 512);
+        }
+
+        TEST_METHOD(MulNTTCarryHeavyOperands)
+        {
+            // Every convolution term is as large as it can be, the chinese
+            // remainder step has to carry the full range.
+            PNUMBER a = MakeAllOnes(2000);
+            PNUMBER b = MakeAllOnes(1500);
+
+            PNUMBER expected = Multiply(a, b, INT32_MAX, INT32_MAX);
+            PNUMBER actual = Multiply(a, b, INT32_MAX, INT32_MAX, 1);
+            VERIFY_IS_TRUE(AreIdentical(expected, actual));
+
+            destroynum(actual);
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(SqrMatchesMultiply)
+        {
+            MulThresholds thresholds(32, 160, 512);
+            for (int32_t cdigit : { 1, 2, 31, 40, 200, 700, 1300 })
+            {
+                PNUMBER a = MakeNumber(cdigit, cdigit);
+                a->sign = -1;
+                a->exp = -5;
+                PNUMBER b = nullptr;
+                DUPNUM(b, a);
+
+                PNUMBER expected = Multiply(a, b, INT32_MAX, INT32_MAX);
+                sqrnumx(&a);
+                VERIFY_IS_TRUE(AreIdentical(expected, a));
+
+                destroynum(expected);
+                destroynum(b);
+                destroynum(a);
+            }
+
+            // Every split of the square kernels, and carries all the way up.
+            {
+                MulThresholds small(4, 9, INT32_MAX);
+                for (int32_t cdigit = 1; cdigit < 100; cdigit++)
+                {
+                    for (PNUMBER a : { MakeNumber(cdigit, cdigit), MakeAllOnes(cdigit) })
+                    {
+                        PNUMBER expected = Multiply(a, a, INT32_MAX, INT32_MAX);
+                        sqrnumx(&a);
+                        VERIFY_IS_TRUE(AreIdentical(expected, a));
+                        destroynum(expected);
+                        destroynum(a);
+                    }
+                }
+            }
+
+            PNUMBER minusone = i32tonum(-1, BASEX);
+            sqrnumx(&minusone);
+            VERIFY_IS_TRUE(AreIdentical(num_one, minusone));
+            destroynum(minusone);
+        }
+
+        TEST_METHOD(PowMatchesRepeatedMultiply)
+        {
+            for (int32_t power : { 0, 1, 2, 3, 7, 8, 255, 256, 300, 1000, 40000 })
+            {
+                PNUMBER a = MakeNumber({ 3, 1 });
+                a->sign = -1;
+                a->exp = -1;
+                PNUMBER expected = i32tonum(1, BASEX);
+                PNUMBER base = nullptr;
+                DUPNUM(base, a);
+                for (int32_t i = 0; i < power; i++)
+                {
+                    mulnumx(&expected, base);
+                }
+                numpowi32x(&a, power);
+                VERIFY_IS_TRUE(equnum(expected, a));
+                VERIFY_ARE_EQUAL(expected->sign, a->sign);
+                destroynum(base);
+                destroynum(expected);
+                destroynum(a);
+            }
+
+            // 3**40 as a rational, and its inverse.
+            PRAT three = i32torat(3);
+            PRAT x = nullptr;
+            DUPRAT(x, three);
+            ratpowi32(&x, 40, 128);
+            PNUMBER expected = i32tonum(1, BASEX);
+            for (int32_t i = 0; i < 40; i++)
+            {
+                mulnumx(&expected, three->pp);
+            }
+            VERIFY_IS_TRUE(equnum(expected, x->pp));
+            VERIFY_IS_TRUE(equnum(num_one, x->pq));
+            DUPRAT(x, three);
+            ratpowi32(&x, -40, 128);
+            VERIFY_IS_TRUE(equnum(num_one, x->pp));
+            VERIFY_IS_TRUE(equnum(expected, x->pq));
+
+            // The root can be left alone, as the constants are.
+            ratpowi32(&x, three, 40, 128);
+            VERIFY_IS_TRUE(equnum(expected, x->pp));
+            VERIFY_IS_TRUE(equnum(num_one, x->pq));
+            VERIFY_ARE_EQUAL(3, rattoi32(three, 10, 128));
+            ratpowi32(&x, rat_exp, 0, 128);
+            VERIFY_IS_TRUE(rat_equ(x, rat_one, 128));
+            destroynum(expected);
+            destroyrat(x);
+            destroyrat(three);
+        }
+
+        TEST_METHOD(DivExactQuotients)
+        {
+            uint32_t seed = 100;
+            for (const auto& length : vector<pair<int32_t, int32_t>>{ { 1, 1 }, { 1, 5 }, { 5, 1 }, { 2, 2 }, { 7, 3 }, { 3, 7 }, { 20, 20 }, { 40, 9 } })
+            {
+                PNUMBER q = MakeNumber(length.first, seed++);
+                PNUMBER b = MakeNumber(length.second, seed++);
+                q->exp = -2;
+                b->sign = -1;
+                b->exp = 4;
+                PNUMBER a = nullptr;
+                DUPNUM(a, q);
+                mulnumx(&a, b);
+
+                PNUMBER c = Divide(a, b, 50);
+                VERIFY_IS_TRUE(equnum(q, c));
+                VERIFY_ARE_EQUAL(1, c->sign);
+
+                destroynum(c);
+                destroynum(a);
+                destroynum(b);
+                destroynum(q);
+            }
+
+            // Trailing zero digits in the quotient are dropped, not kept.
+            PNUMBER a = MakeNumber({ 0, 0, 6 });
+            PNUMBER b = MakeNumber({ 3 });
+            PNUMBER c = Divide(a, b, 10);
+            VERIFY_ARE_EQUAL(1, c->cdigit);
+            VERIFY_ARE_EQUAL(2, c->exp);
+            VERIFY_ARE_EQUAL(2u, (uint32_t)c->mant[0]);
+            destroynum(c);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(DivInexactQuotients)
+        {
+            uint32_t seed = 200;
+            for (const auto& length : vector<pair<int32_t, int32_t>>{ { 1, 1 }, { 1, 2 }, { 3, 1 }, { 4, 3 }, { 3, 4 }, { 30, 17 }, { 12, 40 } })
+            {
+                PNUMBER a = MakeNumber(length.first, seed++);
+                PNUMBER b = MakeNumber(length.second, seed++);
+                b->exp = -3;
+                for (int32_t precision : { 1, 5, 30 })
+                {
+                    PNUMBER c = Divide(a, b, precision);
+                    VERIFY_IS_LESS_THAN_OR_EQUAL(c->cdigit, max({ precision + g_ratio, a->cdigit, b->cdigit }));
+                    VerifyQuotient(a, b, c);
+                    destroynum(c);
+                }
+                destroynum(b);
+                destroynum(a);
+            }
+        }
+
+        TEST_METHOD(DivHardQuotientDigits)
+        {
+            // The first quotient digit guessed from the top digits is one too
+            // large and has to be corrected by adding the divisor back.
+            PNUMBER a = MakeNumber({ 1, BASEX - 1, BASEX - 2, BASEX - 1 });
+            PNUMBER b = MakeNumber({ BASEX - 2, 1, BASEX / 2 + 1 });
+            PNUMBER c = Divide(a, b, 10);
+            VerifyQuotient(a, b, c);
+            destroynum(c);
+            destroynum(b);
+            destroynum(a);
+
+            // Divisors with the smallest and the largest possible top digit.
+            a = MakeAllOnes(9);
+            for (auto digits : { initializer_list<MANTTYPE>{ BASEX - 1, 1 }, { 5, 0, 0, BASEX - 1 }, { BASEX - 1, BASEX - 1, BASEX - 1 } })
+            {
+                b = MakeNumber(digits);
+                c = Divide(a, b, 12);
+                VerifyQuotient(a, b, c);
+                destroynum(c);
+                destroynum(b);
+            }
+            destroynum(a);
+        }
+
+        TEST_METHOD(DivRecursiveMatchesLongDivision)
+        {
+            uint32_t seed = 300;
+            for (const auto& length : vector<pair<int32_t, int32_t>>{ { 8, 4 }, { 20, 9 }, { 64, 30 }, { 150, 37 }, { 90, 90 }, { 200, 120 } })
+            {
+                PNUMBER a = MakeNumber(length.first, seed++);
+                PNUMBER b = MakeNumber(length.second, seed++);
+                for (int32_t precision : { 10, 100, 300 })
+                {
+                    PNUMBER expected = Divide(a, b, precision);
+                    PNUMBER actual = Divide(a, b, precision, 4);
+                    VERIFY_IS_TRUE(AreIdentical(expected, actual));
+                    destroynum(actual);
+                    actual = Divide(a, b, precision, 17);
+                    VERIFY_IS_TRUE(AreIdentical(expected, actual));
+                    destroynum(actual);
+                    destroynum(expected);
+                }
+
+                // Exact quotients come out without trailing zero digits.
+                PNUMBER product = nullptr;
+                DUPNUM(product, a);
+                mulnumx(&product, b);
+                PNUMBER quotient = Divide(product, b, 300, 4);
+                VERIFY_IS_TRUE(AreIdentical(a, quotient));
+                destroynum(quotient);
+                destroynum(product);
+
+                destroynum(b);
+                destroynum(a);
+            }
+
+            // Divisors of all ones make the corrections after each half
+            // division as large as they get.
+            PNUMBER a = MakeAllOnes(160);
+            PNUMBER b = MakeAllOnes(50);
+            b->mant[0] = 0;
+            PNUMBER expected = Divide(a, b, 200);
+            PNUMBER actual = Divide(a, b, 200, 4);
+            VERIFY_IS_TRUE(AreIdentical(expected, actual));
+            destroynum(actual);
+            destroynum(expected);
+            destroynum(b);
+
+            // A divisor with a small top digit is shifted far to normalize
+            // it, which carries digits of the dividend into the zero digit
+            // above it, the first window has to start from there.
+            b = MakeNumber(70, 7);
+            b->mant[69] = 1;
+            expected = Divide(a, b, 200);
+            actual = Divide(a, b, 200, 4);
+            VERIFY_IS_TRUE(AreIdentical(expected, actual));
+            destroynum(actual);
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(MulZeroDigits)
+        {
+            // Runs of zero digits exercise the borrows in the interpolation.
+            PNUMBER a = MakeNumber(200, 11);
+            PNUMBER b = MakeNumber(190, 12);
+            for (int32_t i = 0; i < 120; i++)
+            {
+                a->mant[i] = 0;
+                b->mant[70 + i] = 0;
+            }
+
+            PNUMBER expected = Multiply(a, b, INT32_MAX, INT32_MAX);
+            PNUMBER karatsuba = Multiply(a, b, 4, INT32_MAX);
+            PNUMBER toom3 = Multiply(a, b, 4, 9);
+            VERIFY_IS_TRUE(AreIdentical(expected, karatsuba));
+            VERIFY_IS_TRUE(AreIdentical(expected, toom3));
+
+            destroynum(toom3);
+            destroynum(karatsuba);
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(DivRadixQuotients)
+        {
+            // 1 / 7 in radix 10, precision + 2 digits less the leading zero.
+            PNUMBER a = i32tonum(1, 10);
+            PNUMBER b = i32tonum(7, 10);
+            divnum(&a, b, 10, 12);
+            VERIFY_ARE_EQUAL(13, a->cdigit);
+            VERIFY_ARE_EQUAL(-13, a->exp);
+            const MANTTYPE sevenths[] = { 1, 7, 5, 8, 2, 4, 1, 7, 5, 8, 2, 4, 1 };
+            VERIFY_ARE_EQUAL(0, memcmp(sevenths, a->mant, sizeof(sevenths)));
+            destroynum(b);
+            destroynum(a);
+
+            // Exact quotients stop at the last nonzero digit.
+            a = i32tonum(0xfff0, 16);
+            b = i32tonum(-3, 16);
+            divnum(&a, b, 16, 20);
+            PNUMBER expected = i32tonum(-0x5550, 16);
+            expected->cdigit--;
+            expected->exp++;
+            memmove(expected->mant, expected->mant + 1, expected->cdigit * sizeof(MANTTYPE));
+            VERIFY_IS_TRUE(AreIdentical(expected, a));
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+
+            // c * b <= a < (c + radix**c->exp) * b, whatever the radix.
+            uint32_t seed = 500;
+            for (uint32_t radix : { 2u, 10u, 16u, 36u })
+            {
+                for (const auto& length : vector<pair<int32_t, int32_t>>{ { 1, 1 }, { 9, 1 }, { 9, 2 }, { 30, 12 }, { 12, 30 }, { 64, 40 } })
+                {
+                    a = MakeRadixNumber(length.first, seed++, radix);
+                    b = MakeRadixNumber(length.second, seed++, radix);
+                    a->exp = 2;
+                    PNUMBER c = nullptr;
+                    DUPNUM(c, a);
+                    divnum(&c, b, radix, 40);
+
+                    PNUMBER low = nullptr;
+                    DUPNUM(low, c);
+                    mulnum(&low, b, radix);
+                    VERIFY_IS_FALSE(lessnum(a, low));
+
+                    PNUMBER high = i32tonum(1, radix);
+                    high->exp = c->exp;
+                    addnum(&high, c, radix);
+                    mulnum(&high, b, radix);
+                    VERIFY_IS_TRUE(lessnum(a, high));
+
+                    destroynum(high);
+                    destroynum(low);
+                    destroynum(c);
+                    destroynum(b);
+                    destroynum(a);
+                }
+            }
+        }
+
+        TEST_METHOD(RemMatchesDivision)
+        {
+            uint32_t seed = 600;
+            for (uint64_t radix : { uint64_t{ 10 }, BASEX })
+            {
+                for (const auto& length : vector<pair<int32_t, int32_t>>{ { 1, 1 }, { 5, 1 }, { 5, 2 }, { 20, 7 }, { 7, 7 }, { 60, 25 } })
+                {
+                    for (int32_t exp : { -3, 0, 3 })
+                    {
+                        PNUMBER a = MakeRadixNumber(length.first, seed++, radix);
+                        PNUMBER b = MakeRadixNumber(length.second, seed++, radix);
+                        a->sign = -1;
+                        a->exp = exp;
+                        b->sign = -1;
+                        PNUMBER r = nullptr;
+                        DUPNUM(r, a);
+                        remnum(&r, b, radix);
+
+                        // The remainder is smaller than b, keeps the sign of a
+                        // and a - r is a multiple of b.
+                        VERIFY_IS_TRUE(lessnum(r, b));
+                        VERIFY_IS_TRUE(zernum(r) || r->sign == -1);
+                        PNUMBER q = nullptr;
+                        DUPNUM(q, r);
+                        q->sign = -q->sign;
+                        addnum(&q, a, radix);
+                        if (!zernum(q))
+                        {
+                            divnum(&q, b, radix, 200);
+                            VERIFY_IS_TRUE(q->exp >= 0);
+                        }
+
+                        destroynum(q);
+                        destroynum(r);
+                        destroynum(b);
+                        destroynum(a);
+                    }
+                }
+            }
+
+            // A remainder of zero comes out as a plain zero.
+            PNUMBER a = MakeNumber({ 0, 6 });
+            PNUMBER b = MakeNumber({ 3 });
+            remnum(&a, b, BASEX);
+            PNUMBER zero = i32tonum(0, BASEX);
+            VERIFY_IS_TRUE(AreIdentical(zero, a));
+            destroynum(zero);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(ConvRecursiveMatchesChunks)
+        {
+            // 12345678901234567890 == 0xab54a98ceb1f0ad2
+            PNUMBER a = MakeNumber({ 0, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 9, 8, 7, 6, 5, 4, 3, 2, 1 });
+            PNUMBER expected = MakeNumber({ 0xeb1f0ad2, 0xab54a98c });
+            PNUMBER x = ToBaseX(a, 10);
+            VERIFY_IS_TRUE(AreIdentical(expected, x));
+            destroynum(x);
+            x = ToBaseX(a, 10, 1);
+            VERIFY_IS_TRUE(AreIdentical(expected, x));
+            PNUMBER back = FromBaseX(x, 10, 1);
+            VERIFY_IS_TRUE(AreIdentical(a, back));
+            destroynum(back);
+            destroynum(x);
+            destroynum(expected);
+            destroynum(a);
+
+            // Both ways give the same digits as working a chunk at a time, and
+            // the digits come back unchanged.
+            uint32_t seed = 700;
+            for (uint32_t radix : { 2u, 10u, 16u, 36u })
+            {
+                for (int32_t cdigit : { 1, 9, 10, 70, 333, 2000 })
+                {
+                    a = MakeRadixNumber(cdigit, seed++, radix);
+                    a->mant[0] = 0;
+                    a->sign = -1;
+                    expected = ToBaseX(a, radix);
+                    for (int32_t dc : { 2, 5 })
+                    {
+                        x = ToBaseX(a, radix, dc);
+                        VERIFY_IS_TRUE(AreIdentical(expected, x));
+                        back = FromBaseX(x, radix, dc);
+                        VERIFY_IS_TRUE(AreIdentical(a, back));
+                        destroynum(back);
+                        destroynum(x);
+                    }
+                    back = FromBaseX(expected, radix);
+                    VERIFY_IS_TRUE(AreIdentical(a, back));
+                    destroynum(back);
+                    destroynum(expected);
+                    destroynum(a);
+                }
+            }
+
+            // Runs of zeros and of the largest digit inside the number.
+            a = MakeRadixNumber(500, 800, 10);
+            for (int32_t i = 100; i < 300; i++)
+            {
+                a->mant[i] = (i < 200) ? 0 : 9;
+            }
+            expected = ToBaseX(a, 10);
+            x = ToBaseX(a, 10, 2);
+            VERIFY_IS_TRUE(AreIdentical(expected, x));
+            back = FromBaseX(x, 10, 2);
+            VERIFY_IS_TRUE(AreIdentical(a, back));
+            destroynum(back);
+            destroynum(x);
+            destroynum(expected);
+            destroynum(a);
+        }
+
+        TEST_METHOD(GcdMatchesEuclid)
+        {
+            uint32_t seed = 900;
+            for (const auto& length : vector<pair<int32_t, int32_t>>{ { 1, 1 }, { 2, 1 }, { 2, 2 }, { 3, 2 }, { 5, 5 }, { 20, 3 }, { 40, 37 }, { 1, 60 } })
+            {
+                for (int32_t cg : { 1, 2, 7 })
+                {
+                    // Multiples of a common factor, one with its trailing zero
+                    // digits in the exponent.
+                    PNUMBER g = MakeNumber(cg, seed++);
+                    PNUMBER a = MakeNumber(length.first, seed++);
+                    PNUMBER b = MakeNumber(length.second, seed++);
+                    mulnumx(&a, g);
+                    mulnumx(&b, g);
+                    a->exp = 1;
+
+                    PNUMBER expected = EuclidGcd(a, b);
+                    PNUMBER actual = gcd(a, b);
+                    VERIFY_IS_TRUE(actual->sign == 1);
+                    VERIFY_IS_FALSE(lessnum(actual, expected) || lessnum(expected, actual));
+                    destroynum(actual);
+                    actual = gcd(b, a);
+                    VERIFY_IS_FALSE(lessnum(actual, expected) || lessnum(expected, actual));
+
+                    destroynum(actual);
+                    destroynum(expected);
+                    destroynum(b);
+                    destroynum(a);
+                    destroynum(g);
+                }
+            }
+
+            // Neighbouring Fibonacci numbers take the most steps.
+            PNUMBER a = i32tonum(1, BASEX);
+            PNUMBER b = i32tonum(1, BASEX);
+            for (int32_t i = 0; i < 1000; i++)
+            {
+                addnum(&a, b, BASEX);
+                swap(a, b);
+            }
+            PNUMBER actual = gcd(a, b);
+            PNUMBER one = i32tonum(1, BASEX);
+            VERIFY_IS_TRUE(AreIdentical(one, actual));
+            destroynum(one);
+            destroynum(actual);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(ExactResultsAreReduced)
+        {
+            // The sum of 1/k for k up to 60 has a 3 digit denominator once
+            // reduced, left alone p and q would outgrow the precision and be
+            // cut.  Reduced as they reach g_gcdThreshold digits they stay
+            // short and exact.
+            PRAT sum = nullptr;
+            PRAT exact = nullptr;
+            DUPRAT(sum, rat_zero);
+            DUPRAT(exact, rat_zero);
+            int32_t threshold = g_gcdThreshold;
+            for (int32_t k = 1; k <= 60; k++)
+            {
+                PRAT term = nullptr;
+                createrat(term);
+                term->pp = i32tonum(1, BASEX);
+                term->pq = i32tonum(k, BASEX);
+                addrat(&sum, term, 128);
+                VERIFY_IS_TRUE(sum->pp->cdigit + sum->pp->exp <= threshold && sum->pq->cdigit + sum->pq->exp <= threshold);
+
+                g_gcdThreshold = INT32_MAX;
+                addrat(&exact, term, INT32_MAX);
+                g_gcdThreshold = threshold;
+                destroyrat(term);
+            }
+            VERIFY_IS_TRUE(rat_equ(sum, exact, INT32_MAX));
+
+            // Short results are left to grow, 1/3 + 1/6 stays 9/18.
+            PRAT a = nullptr;
+            PRAT b = nullptr;
+            createrat(a);
+            createrat(b);
+            a->pp = i32tonum(1, BASEX);
+            a->pq = i32tonum(3, BASEX);
+            b->pp = i32tonum(1, BASEX);
+            b->pq = i32tonum(6, BASEX);
+            addrat(&a, b, 128);
+            PNUMBER nine = i32tonum(9, BASEX);
+            PNUMBER eighteen = i32tonum(18, BASEX);
+            VERIFY_IS_TRUE(AreIdentical(nine, a->pp));
+            VERIFY_IS_TRUE(AreIdentical(eighteen, a->pq));
+
+            destroynum(eighteen);
+            destroynum(nine);
+            destroyrat(b);
+            destroyrat(a);
+            destroyrat(exact);
+            destroyrat(sum);
+        }
+
+        TEST_METHOD(CompareMatchesDifference)
+        {
+            // The sign of a - b decides every comparison, signs on either
+            // half and magnitudes near and far apart.
+            uint32_t seed = 2000;
+            for (int32_t cdigit : { 1, 2, 5, 40 })
+            {
+                for (int32_t shift : { 0, 1, 2, 3 })
+                {
+                    PRAT a = nullptr;
+                    PRAT b = nullptr;
+                    createrat(a);
+                    createrat(b);
+                    a->pp = MakeNumber(cdigit, seed++);
+                    a->pq = MakeNumber(cdigit, seed++);
+                    b->pp = MakeNumber(cdigit + shift, seed++);
+                    b->pq = MakeNumber(cdigit, seed++);
+                    for (int32_t signs = 0; signs < 16; signs++)
+                    {
+                        a->pp->sign = (signs & 1) ? -1 : 1;
+                        a->pq->sign = (signs & 2) ? -1 : 1;
+                        b->pp->sign = (signs & 4) ? -1 : 1;
+                        b->pq->sign = (signs & 8) ? -1 : 1;
+                        for (PRAT other : { b, a, rat_zero })
+                        {
+                            PRAT diff = nullptr;
+                            DUPRAT(diff, a);
+                            subrat(&diff, other, 128);
+                            int32_t expected = zerrat(diff) ? 0 : SIGN(diff);
+                            destroyrat(diff);
+                            VERIFY_ARE_EQUAL(expected, ratcmp(a, other));
+                            VERIFY_ARE_EQUAL(-expected, ratcmp(other, a));
+                            VERIFY_ARE_EQUAL(expected == 0, rat_equ(a, other, 128));
+                            VERIFY_ARE_EQUAL(expected < 0, rat_lt(a, other, 128));
+                            VERIFY_ARE_EQUAL(expected >= 0, rat_ge(a, other, 128));
+                        }
+                        // The signs are left as they were.
+                        VERIFY_ARE_EQUAL((signs & 4) ? -1 : 1, b->pp->sign);
+                    }
+                    destroyrat(b);
+                    destroyrat(a);
+                }
+            }
+        }
+
+        TEST_METHOD(SeriesMatchesClosedForms)
+        {
+            // 1 + x + x**2 + ... == 1 / (1 - x)
+            for (int32_t den : { 2, -3, 1000 })
+            {
+                PRAT sum = i32torat(1);
+                PRAT x = i32torat(1);
+                PRAT y = i32torat(den);
+                divrat(&x, y, 128);
+                sumseries(
+                    &sum,
+                    x,
+                    [](uint32_t, uint64_t* pnum, uint64_t* pden) {
+                        *pnum = 1;
+                        *pden = 1;
+                    },
+                    TAYLOR_EXP,
+                    128);
+                PRAT expected = i32torat(1);
+                subrat(&expected, x, 128);
+                PRAT one = i32torat(1);
+                divrat(&one, expected, 128);
+                subrat(&one, sum, 128);
+                VERIFY_IS_TRUE(rat_le(one, rat_smallest, 128) && rat_ge(one, rat_negsmallest, 128));
+                destroyrat(one);
+                destroyrat(expected);
+                destroyrat(y);
+                destroyrat(x);
+                destroyrat(sum);
+            }
+
+            // e from its series, and a zero ratio leaves the first term.
+            PRAT e = i32torat(1);
+            sumseries(
+                &e,
+                rat_one,
+                [](uint32_t j, uint64_t* pnum, uint64_t* pden) {
+                    *pnum = 1;
+                    *pden = j + 1;
+                },
+                TAYLOR_EXP,
+                128);
+            subrat(&e, rat_exp, 128);
+            VERIFY_IS_TRUE(rat_le(e, rat_smallest, 128) && rat_ge(e, rat_negsmallest, 128));
+            PRAT half = i32torat(1);
+            divrat(&half, rat_two, 128);
+            sumseries(
+                &half,
+                rat_zero,
+                [](uint32_t, uint64_t* pnum, uint64_t* pden) {
+                    *pnum = 1;
+                    *pden = 1;
+                },
+                TAYLOR_EXP,
+                128);
+            VERIFY_IS_TRUE(rat_equ(half, rat_half, 128));
+            destroyrat(half);
+            destroyrat(e);
+        }
+
+        TEST_METHOD(ExpOfLongArguments)
+        {
+            // exp(x) * exp(-x) == 1 for x with all the digits of precision,
+            // which exprat halves and squares back.
+            for (int32_t num : { 1, -5, 22, 7 })
+            {
+                PRAT x = i32torat(num);
+                divrat(&x, pi, 128);
+                PRAT negx = nullptr;
+                DUPRAT(negx, x);
+                negx->pp->sign *= -1;
+                exprat(&x, 10, 128);
+                exprat(&negx, 10, 128);
+                mulrat(&x, negx, 128);
+                subrat(&x, rat_one, 128);
+                VERIFY_IS_TRUE(rat_le(x, rat_smallest, 128) && rat_ge(x, rat_negsmallest, 128));
+                destroyrat(negx);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(LogAGMMatchesSeries)
+        {
+            // Short and long arguments, and ones near one that carry guard
+            // digits through the mean.
+            int32_t savedagm = g_logAGMThreshold;
+            for (int32_t num : { 2, 10, -3, 1000000, 22, 1001, 100000001 })
+            {
+                PRAT x = i32torat(num);
+                if (num < 0)
+                {
+                    x->pp->sign = 1;
+                    divrat(&x, rat_ten, 128);
+                }
+                else if (num == 22)
+                {
+                    divrat(&x, pi, 128);
+                }
+                else if (num > 1000000)
+                {
+                    PRAT den = i32torat(num - 1);
+                    divrat(&x, den, 128);
+                    destroyrat(den);
+                }
+                else if (num == 1001)
+                {
+                    PRAT den = i32torat(1000);
+                    divrat(&x, den, 128);
+                    destroyrat(den);
+                }
+                PRAT agm = nullptr;
+                DUPRAT(agm, x);
+
+                g_logAGMThreshold = INT32_MAX;
+                lograt(&x, 128);
+                g_logAGMThreshold = 1;
+                lograt(&agm, 128);
+
+                divrat(&agm, x, 128);
+                subrat(&agm, rat_one, 128);
+                VERIFY_IS_TRUE(rat_le(agm, rat_smallest, 128) && rat_ge(agm, rat_negsmallest, 128));
+                destroyrat(agm);
+                destroyrat(x);
+            }
+            g_logAGMThreshold = savedagm;
+        }
+
+        TEST_METHOD(ConstantsMatchSeries)
+        {
+            // pi from Chudnovsky against 6 asin(1/2), ln_two and ln_ten from
+            // atanh against lograt.
+            PRAT asinpi = nullptr;
+            DUPRAT(asinpi, rat_half);
+            asinrat(&asinpi, 10, 128);
+            PRAT six = i32torat(6);
+            mulrat(&asinpi, six, 128);
+            subrat(&asinpi, pi, 128);
+            VERIFY_IS_TRUE(rat_le(asinpi, rat_smallest, 128) && rat_ge(asinpi, rat_negsmallest, 128));
+
+            int32_t savedagm = g_logAGMThreshold;
+            g_logAGMThreshold = INT32_MAX;
+            PRAT logtwo = i32torat(2);
+            lograt(&logtwo, 128);
+            subrat(&logtwo, ln_two, 128);
+            VERIFY_IS_TRUE(rat_le(logtwo, rat_smallest, 128) && rat_ge(logtwo, rat_negsmallest, 128));
+            PRAT logten = i32torat(10);
+            lograt(&logten, 128);
+            subrat(&logten, ln_ten, 128);
+            VERIFY_IS_TRUE(rat_le(logten, rat_smallest, 128) && rat_ge(logten, rat_negsmallest, 128));
+            g_logAGMThreshold = savedagm;
+
+            destroyrat(logten);
+            destroyrat(logtwo);
+            destroyrat(six);
+            destroyrat(asinpi);
+        }
+
+        TEST_METHOD(ConstantsKeptPerPrecision)
+        {
+            // Going back to a precision restores its constants digit for digit,
+            // and a lower one cuts back the longer set.
+            ChangeConstants(10, 200);
+            PRAT pi200 = nullptr;
+            DUPRAT(pi200, pi);
+            resetratpakstats();
+            ChangeConstants(10, 150);
+            PRAT cut = nullptr;
+            DUPRAT(cut, pi200);
+            trimit(&cut, 150 + g_ratio);
+            VERIFY_IS_TRUE(AreIdentical(pi->pp, cut->pp) && AreIdentical(pi->pq, cut->pq));
+            ChangeConstants(10, 200);
+            VERIFY_IS_TRUE(AreIdentical(pi->pp, pi200->pp) && AreIdentical(pi->pq, pi200->pq));
+#if RATPAK_TELEMETRY
+            VERIFY_ARE_EQUAL(0ull, getratpakstats().cterm[TAYLOR_PI]);
+#endif
+            ChangeConstants(10, 128);
+            destroyrat(cut);
+            destroyrat(pi200);
+        }
+
+        TEST_METHOD(RootIsIntegerRoot)
+        {
+            // r**n <= a < (r + 1)**n, and exact only for perfect powers.
+            uint32_t seed = 1000;
+            for (int32_t n : { 2, 3, 5, 32 })
+            {
+                for (int32_t cdigit : { 1, 2, 3, 8, 41, 200 })
+                {
+                    PNUMBER a = MakeNumber(cdigit, seed++);
+                    PNUMBER r = nullptr;
+                    DUPNUM(r, a);
+                    bool fexact = rootnumx(&r, n);
+
+                    PNUMBER low = nullptr;
+                    DUPNUM(low, r);
+                    numpowi32x(&low, n);
+                    VERIFY_IS_FALSE(lessnum(a, low));
+                    VERIFY_ARE_EQUAL(equnum(a, low), fexact);
+                    PNUMBER high = nullptr;
+                    DUPNUM(high, r);
+                    addnum(&high, num_one, BASEX);
+                    numpowi32x(&high, n);
+                    VERIFY_IS_TRUE(lessnum(a, high));
+
+                    // The nth power of r gives r back exactly.
+                    PNUMBER root = nullptr;
+                    DUPNUM(root, low);
+                    VERIFY_IS_TRUE(rootnumx(&root, n));
+                    VERIFY_IS_TRUE(equnum(root, r));
+
+                    // One less than it has r - 1 for its root.
+                    PNUMBER lessone = i32tonum(-1, BASEX);
+                    addnum(&low, lessone, BASEX);
+                    if (!zernum(low))
+                    {
+                        VERIFY_IS_FALSE(rootnumx(&low, n));
+                        addnum(&low, num_one, BASEX);
+                        VERIFY_IS_TRUE(equnum(low, r));
+                    }
+
+                    destroynum(lessone);
+                    destroynum(root);
+                    destroynum(high);
+                    destroynum(low);
+                    destroynum(r);
+                    destroynum(a);
+                }
+            }
+
+            // Powers of BASEX, with and without an exponent.
+            PNUMBER a = MakeNumber({ 0, 0, 0, 0, 0, 0, 1 });
+            PNUMBER b = MakeNumber({ 1 });
+            b->exp = 6;
+            PNUMBER expected = MakeNumber({ 0, 0, 1 });
+            VERIFY_IS_TRUE(rootnumx(&a, 3));
+            VERIFY_IS_TRUE(equnum(expected, a));
+            VERIFY_IS_TRUE(rootnumx(&b, 3));
+            VERIFY_IS_TRUE(equnum(expected, b));
+            destroynum(expected);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(InPlaceMatchesFreshResults)
+        {
+            // Each operation with and without room in the destination, with
+            // room it has to leave the result where the destination was.
+            for (int32_t room : { 0, 512 })
+            {
+                // Lined up under b, then borrowing through every digit.
+                PNUMBER a = WithRoom(MakeNumber({ 1, 2, 3 }), room);
+                a->exp = 2;
+                PNUMBER b = MakeNumber({ 5 });
+                PNUMBER before = a;
+                addnum(&a, b, BASEX);
+                PNUMBER expected = MakeNumber({ 5, 0, 1, 2, 3 });
+                VERIFY_IS_TRUE(AreIdentical(expected, a));
+                VERIFY_IS_TRUE(room == 0 || a == before);
+                destroynum(expected);
+                destroynum(b);
+
+                b = MakeNumber({ 6, 0, 1, 2, 3 });
+                b->sign = -1;
+                addnum(&a, b, BASEX);
+                expected = MakeNumber({ 1 });
+                expected->sign = -1;
+                VERIFY_IS_TRUE(AreIdentical(expected, a));
+                destroynum(expected);
+                destroynum(b);
+                destroynum(a);
+
+                // One digit factors on either side.
+                a = WithRoom(MakeNumber({ 0xFFFFFFFF, 0xFFFFFFFF }), room);
+                b = MakeNumber({ 2 });
+                before = a;
+                mulnumx(&a, b);
+                expected = MakeNumber({ 0xFFFFFFFE, 0xFFFFFFFF, 1 });
+                VERIFY_IS_TRUE(AreIdentical(expected, a));
+                VERIFY_IS_TRUE(room == 0 || a == before);
+                destroynum(expected);
+                mulnumx(&b, a);
+                expected = MakeNumber({ 0xFFFFFFFC, 0xFFFFFFFF, 3 });
+                VERIFY_IS_TRUE(AreIdentical(expected, b));
+                destroynum(expected);
+                destroynum(b);
+
+                // One digit divisor, exact and not.
+                b = MakeNumber({ 2 });
+                divnumx(&a, b, 128);
+                expected = MakeNumber({ 0xFFFFFFFF, 0xFFFFFFFF });
+                VERIFY_IS_TRUE(AreIdentical(expected, a));
+                destroynum(expected);
+                destroynum(b);
+                destroynum(a);
+
+                PNUMBER ten = MakeNumber({ 10 });
+                PNUMBER three = MakeNumber({ 3 });
+                a = WithRoom(MakeNumber({ 10 }), room);
+                before = a;
+                divnumx(&a, three, 128);
+                VERIFY_IS_TRUE(room == 0 || a == before);
+                VerifyQuotient(ten, three, a);
+                destroynum(three);
+                destroynum(ten);
+                destroynum(a);
+            }
+
+            // DUPNUM keeps a destination that has room.
+            PNUMBER a = MakeNumber(100, 1);
+            PNUMBER b = MakeNumber(40, 2);
+            PNUMBER before = a;
+            DUPNUM(a, b);
+            VERIFY_ARE_EQUAL(before, a);
+            VERIFY_IS_TRUE(AreIdentical(b, a));
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(PoolReusesFreedNumbers)
+        {
+            auto work = [] {
+                PRAT x = i32torat(3);
+                PRAT y = i32torat(7);
+                divrat(&x, y, 128);
+                exprat(&x, 10, 128);
+                lograt(&x, 128);
+                destroyrat(y);
+                destroyrat(x);
+            };
+
+            RATPAKSTATS before{};
+            RATPAKSTATS after{};
+            {
+                RatpakPoolScope scope;
+                work();
+                before = getratpakstats();
+                work();
+                after = getratpakstats();
+            }
+            RATPAKSTATS released = getratpakstats();
+#if RATPAK_TELEMETRY && RATPAK_POOL
+            // Once the first run has filled the free lists the second one runs without the heap.
+            VERIFY_ARE_EQUAL(before.cmalloc, after.cmalloc);
+            VERIFY_IS_TRUE(after.creuse > before.creuse);
+            VERIFY_IS_TRUE(released.cfree > after.cfree);
+#elif RATPAK_TELEMETRY
+            VERIFY_IS_TRUE(after.cmalloc > before.cmalloc);
+            VERIFY_ARE_EQUAL(after.creuse, released.creuse);
+#else
+            VERIFY_ARE_EQUAL(0ull, before.cmalloc + after.creuse + released.cfree);
+#endif
+        }
+
+        TEST_METHOD(TelemetryCountsWork)
+        {
+            resetratpakstats();
+            RATPAKSTATS before = getratpakstats();
+            PRAT x = i32torat(1);
+            PRAT y = i32torat(3);
+            divrat(&x, y, 128);
+            exprat(&x, 10, 128);
+            sinanglerat(&x, AngleType::Radians, 10, 128);
+            RATPAKSTATS during = getratpakstats();
+            destroyrat(y);
+            destroyrat(x);
+            RATPAKSTATS after = getratpakstats();
+            string json = ratpakstatstojson(after);
+#if RATPAK_TELEMETRY
+            VERIFY_IS_TRUE(during.mulnumx.ccall > 0 && during.mulnumx.cdigit >= 2 * during.mulnumx.ccall);
+            VERIFY_IS_TRUE(during.addnum.ccall > 0);
+            VERIFY_IS_TRUE(during.trimit.ccall > 0);
+            VERIFY_IS_TRUE(during.cterm[TAYLOR_EXP] > 0);
+            VERIFY_IS_TRUE(during.cterm[TAYLOR_SIN] > 0);
+            VERIFY_ARE_EQUAL(0ull, during.cterm[TAYLOR_LOG]);
+            // Every number made along the way has been destroyed again.
+            VERIFY_ARE_EQUAL(before.clivenum, after.clivenum);
+            VERIFY_IS_TRUE(after.cpeaknum > before.clivenum + 4);
+            VERIFY_IS_TRUE(json.find("\"enabled\":true") != string::npos);
+#else
+            VERIFY_ARE_EQUAL(0ull, during.mulnumx.ccall);
+            VERIFY_ARE_EQUAL(0ll, after.cpeaknum);
+            VERIFY_IS_TRUE(json.find("\"enabled\":false") != string::npos);
+#endif
+            VERIFY_IS_TRUE(json.find("\"taylorterms\":{\"exp\":") != string::npos);
+        }
+
+        TEST_METHOD(ConstantsKeepPrecision)
+        {
+            // Coming back to a precision past the ratconst.h table computes
+            // the constants again instead of reading the table.
+            PRAT exp128 = nullptr;
+            DUPRAT(exp128, rat_exp);
+            ChangeConstants(10, 32);
+            ChangeConstants(10, 128);
+            VERIFY_IS_TRUE(rat_equ(rat_exp, exp128, 128));
+            ChangeConstants(10, 128);
+            VERIFY_IS_TRUE(rat_equ(rat_exp, exp128, 128));
+            destroyrat(exp128);
+        }
+    };
+}